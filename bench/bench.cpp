@@ -0,0 +1,358 @@
+// throughput benchmark of matching engines
+//
+// build & run (from the root of repository):
+//   cmake -S . -B build && cmake --build build --target rex-bench
+//   ./build/rex-bench [options]
+// or without CMake ('-pthread' is required by the thread pool):
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/bench.cpp src/re/*/*.cpp
+//       -o rex-bench
+//
+// options:
+//   --sizes N,N,...    sizes of inputs in bytes (suffix 'k', 'm' & 'g'
+//                      are supported), default '16,4k,1m,16m'
+//   --min-time SEC     minimal running time of each case, default 0.2
+//   --filter STR       only run the cases whose name contains 'STR'
+//   --format FMT       'text' (default), 'json' (one object per line)
+//                      or 'csv'
+//
+// NOTE:  inputs are generated in memory, so multi-GB inputs need
+//        enough memory, engine construction is not timed
+
+#include <re/re.h>
+
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+using namespace rex::re;
+
+namespace {
+
+// generator of input with specific size
+using InputGen = std::function<std::string(std::size_t)>;
+// runs engine on input, returns a value that depends on the result
+using Runner = std::function<std::size_t(std::string_view)>;
+
+struct Case {
+    std::string shape, pattern, engine;
+    InputGen input;
+    Runner run;
+};
+
+struct Result {
+    std::string shape, pattern, engine;
+    std::size_t size, iters;
+    double seconds;
+};
+
+// options of benchmark
+struct Options {
+    std::vector<std::size_t> sizes = {16, 4 << 10, 1 << 20, 16 << 20};
+    double min_time = 0.2;
+    std::string filter, format = "text";
+};
+
+REObject ParseOrDie(std::string_view pattern) {
+    Parser parser(pattern);
+    auto reo = parser.Parse();
+    if (!reo) {
+        std::cerr << "invalid pattern '" << pattern << "' at "
+                  << parser.error_pos() << std::endl;
+        std::exit(1);
+    }
+    return reo;
+}
+
+// string that repeats chars picked from 'chars' until 'size'
+InputGen RandomChars(std::string chars, std::string suffix = "") {
+    return [chars, suffix](std::size_t size) {
+        std::mt19937 rng(size);
+        std::string str;
+        str.reserve(size);
+        auto body = size > suffix.size() ? size - suffix.size() : 0;
+        for (std::size_t i = 0; i < body; ++i) {
+            str += chars[rng() % chars.size()];
+        }
+        return str + suffix.substr(0, size - body);
+    };
+}
+
+// string that joins words picked from 'words' until 'size'
+InputGen RandomWords(std::vector<std::string> words, std::string sep) {
+    return [words, sep](std::size_t size) {
+        std::mt19937 rng(size);
+        std::string str;
+        str.reserve(size + 64);
+        while (str.size() < size) {
+            str += words[rng() % words.size()];
+            str += sep;
+        }
+        str.resize(size);
+        return str;
+    };
+}
+
+// log-like text, for unanchored search
+std::string GenerateLog(std::size_t size) {
+    static const char *kLevels[] = {"INFO", "INFO", "INFO", "DEBUG",
+                                    "WARN", "ERROR"};
+    static const char *kUsers[] = {"alice", "bob", "carol", "dave"};
+    std::mt19937 rng(size);
+    std::string str;
+    str.reserve(size + 128);
+    while (str.size() < size) {
+        auto user = kUsers[rng() % 4];
+        str += "2024-0" + std::to_string(rng() % 9 + 1) + "-1" +
+               std::to_string(rng() % 10) + " ";
+        str += kLevels[rng() % 6];
+        str += " user=" + std::string(user) + " id=" +
+               std::to_string(rng() % 100000);
+        str += " mail=" + std::string(user) + "@example.com";
+        str += " msg=request handled in " + std::to_string(rng() % 1000) +
+               "ms\n";
+    }
+    str.resize(size);
+    return str;
+}
+
+// C-like source code, for lexer
+std::string GenerateSource(std::size_t size) {
+    static const char *kWords[] = {
+        "int", "return", "if", "while", "x", "count", "buffer_size",
+        "i", "0", "42", "3.14", "+", "-", "*", "==", "=", "(", ")",
+        "{", "}", ";", "\n", " ", "  ",
+    };
+    std::mt19937 rng(size);
+    std::string str;
+    str.reserve(size + 16);
+    while (str.size() < size) {
+        str += kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))];
+        str += ' ';
+    }
+    str.resize(size);
+    return str;
+}
+
+// add cases of anchored engines for a pattern shape
+void AddAnchoredCases(std::vector<Case> &cases, const std::string &shape,
+        const std::string &pattern, const InputGen &input) {
+    auto reo = ParseOrDie(pattern);
+    auto dfa = std::make_shared<Regex>(reo, Regex::Engine::DFA);
+    auto nfa = std::make_shared<Regex>(reo, Regex::Engine::NFA);
+    auto lazy = std::make_shared<LazyDFA>(reo->GenerateNFA());
+    cases.push_back({shape, pattern, "dfa", input,
+                     [dfa](std::string_view str) {
+                         return dfa->TestString(str.data(), str.size());
+                     }});
+    cases.push_back({shape, pattern, "nfa", input,
+                     [nfa](std::string_view str) {
+                         return nfa->TestString(str.data(), str.size());
+                     }});
+    cases.push_back({shape, pattern, "lazy", input,
+                     [lazy](std::string_view str) {
+                         return lazy->TestString(str.data(), str.size());
+                     }});
+    // small DFAs are compared with & without shuffle table
+    if (auto shuffle = dfa->shuffle()) {
+        auto table = dfa->table();
+        cases.push_back({shape, pattern, "table", input,
+                         [table](std::string_view str) {
+                             return table->TestString(str.data(),
+                                                      str.size());
+                         }});
+        cases.push_back({shape, pattern, "shuffle", input,
+                         [shuffle](std::string_view str) {
+                             return shuffle->TestString(str.data(),
+                                                        str.size());
+                         }});
+    }
+    auto stream = std::make_shared<MatchStream>(dfa->table());
+    cases.push_back({shape, pattern, "stream", input,
+                     [stream](std::string_view str) {
+                         // feed input in chunks of 64KB
+                         constexpr std::size_t kChunk = 64 << 10;
+                         stream->Reset();
+                         for (std::size_t i = 0; i < str.size(); i += kChunk) {
+                             if (!stream->Feed(str.substr(i, kChunk))) break;
+                         }
+                         return stream->Finish();
+                     }});
+}
+
+void AddSearchCase(std::vector<Case> &cases, const std::string &shape,
+        const std::string &pattern) {
+    auto searcher = std::make_shared<Searcher>(ParseOrDie(pattern));
+    cases.push_back({shape, pattern, "search", GenerateLog,
+                     [searcher](std::string_view str) {
+                         return searcher->Count(str);
+                     }});
+}
+
+std::vector<Case> GetCases() {
+    std::vector<Case> cases;
+    // anchored matching
+    AddAnchoredCases(cases, "class", "[a-z0-9_]*",
+                     RandomChars("abcdefghijklmnopqrstuvwxyz0123456789_"));
+    AddAnchoredCases(cases, "alternation", "(?:GET|POST|PUT|DELETE| )*",
+                     RandomWords({"GET", "POST", "PUT", "DELETE"}, " "));
+    AddAnchoredCases(cases, "kleene", "(?:a|b)*abb",
+                     RandomChars("ab", "abb"));
+    AddAnchoredCases(cases, "counted", "(?:[ab]*a[ab]{8})*",
+                     RandomChars("ab"));
+    AddAnchoredCases(cases, "words", "(?:[a-z]+[0-9]*[ ,.])*",
+                     RandomWords({"the", "quick", "fox1", "jumps",
+                                  "over", "lazy", "dog42"}, " "));
+    // unanchored search
+    AddSearchCase(cases, "literal", "ERROR");
+    AddSearchCase(cases, "literal-set", "ERROR|WARN|FATAL|PANIC");
+    AddSearchCase(cases, "class", "[0-9]{4}-[0-9]{2}-[0-9]{2}");
+    AddSearchCase(cases, "kleene", "user=[a-z]+ id=[0-9]+");
+    AddSearchCase(cases, "email", "[a-z]+@[a-z]+\\.(?:com|org)");
+    // lexer grammar
+    auto lexer = std::make_shared<Lexer>();
+    const char *rules[] = {
+        "int|return|if|while", "[A-Za-z_][A-Za-z0-9_]*",
+        "[0-9]+(?:\\.[0-9]+)?", "==|[-+*=(){};]", "[ \\t\\n]+",
+    };
+    for (int i = 0; i < 5; ++i) lexer->AddRule(ParseOrDie(rules[i]), i);
+    lexer->Build();
+    cases.push_back({"lexer", "c-like", "lexer", GenerateSource,
+                     [lexer](std::string_view str) {
+                         return lexer->Tokenize(str.data(), str.size())
+                                 .size();
+                     }});
+    return cases;
+}
+
+Result RunCase(const Case &c, const std::string &input, double min_time) {
+    using Clock = std::chrono::steady_clock;
+    // warm up, then double the iterations until time is enough
+    volatile std::size_t sink = c.run(input);
+    std::size_t iters = 1, total_iters = 0;
+    double seconds = 0;
+    while (seconds < min_time) {
+        auto begin = Clock::now();
+        for (std::size_t i = 0; i < iters; ++i) sink = sink + c.run(input);
+        std::chrono::duration<double> elapsed = Clock::now() - begin;
+        seconds += elapsed.count();
+        total_iters += iters;
+        iters *= 2;
+    }
+    return {c.shape, c.pattern, c.engine, input.size(), total_iters,
+            seconds};
+}
+
+std::string EscapeJSON(const std::string &str) {
+    std::string ret;
+    for (const auto &c : str) {
+        if (c == '"' || c == '\\') ret += '\\';
+        ret += c;
+    }
+    return ret;
+}
+
+void PrintResult(const Result &r, const std::string &format) {
+    auto ns_per_match = r.seconds * 1e9 / r.iters;
+    auto bytes_per_sec = r.size * r.iters / r.seconds;
+    if (format == "json") {
+        std::cout << "{\"shape\":\"" << r.shape << "\",\"pattern\":\""
+                  << EscapeJSON(r.pattern) << "\",\"engine\":\"" << r.engine
+                  << "\",\"size\":" << r.size << ",\"iters\":" << r.iters
+                  << ",\"ns_per_match\":" << ns_per_match
+                  << ",\"bytes_per_sec\":" << bytes_per_sec << "}\n";
+    }
+    else if (format == "csv") {
+        std::cout << r.shape << ",\"" << r.pattern << "\"," << r.engine
+                  << ',' << r.size << ',' << r.iters << ',' << ns_per_match
+                  << ',' << bytes_per_sec << '\n';
+    }
+    else {
+        std::cout << std::left << std::setw(12) << r.shape << std::setw(8)
+                  << r.engine << std::right << std::setw(12) << r.size
+                  << std::setw(16) << std::fixed << std::setprecision(1)
+                  << ns_per_match << std::setw(12) << std::setprecision(2)
+                  << bytes_per_sec / (1 << 20) << "  " << r.pattern << '\n';
+    }
+}
+
+std::size_t ParseSize(const std::string &str) {
+    char *end;
+    std::size_t size = std::strtoull(str.c_str(), &end, 10);
+    switch (*end) {
+        case 'k': case 'K': size <<= 10; break;
+        case 'm': case 'M': size <<= 20; break;
+        case 'g': case 'G': size <<= 30; break;
+        default: break;
+    }
+    return size;
+}
+
+bool ParseOptions(int argc, const char *argv[], Options &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--sizes") {
+            opts.sizes.clear();
+            std::size_t pos = 0;
+            while (pos <= value.size()) {
+                auto comma = value.find(',', pos);
+                if (comma == std::string::npos) comma = value.size();
+                opts.sizes.push_back(ParseSize(value.substr(pos, comma - pos)));
+                pos = comma + 1;
+            }
+        }
+        else if (arg == "--min-time") {
+            opts.min_time = std::atof(value.c_str());
+        }
+        else if (arg == "--filter") {
+            opts.filter = value;
+        }
+        else if (arg == "--format") {
+            opts.format = value;
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    Options opts;
+    if (!ParseOptions(argc, argv, opts)) {
+        std::cerr << "usage: " << argv[0] << " [--sizes N,N,...] "
+                  << "[--min-time SEC] [--filter STR] "
+                  << "[--format text|json|csv]" << std::endl;
+        return 1;
+    }
+    if (opts.format == "csv") {
+        std::cout << "shape,pattern,engine,size,iters,"
+                  << "ns_per_match,bytes_per_sec\n";
+    }
+    else if (opts.format == "text") {
+        std::cout << std::left << std::setw(12) << "shape" << std::setw(8)
+                  << "engine" << std::right << std::setw(12) << "size"
+                  << std::setw(16) << "ns/match" << std::setw(12) << "MB/s"
+                  << "  pattern\n";
+    }
+    for (const auto &c : GetCases()) {
+        auto name = c.shape + "/" + c.engine;
+        if (name.find(opts.filter) == std::string::npos) continue;
+        for (const auto &size : opts.sizes) {
+            PrintResult(RunCase(c, c.input(size), opts.min_time),
+                        opts.format);
+        }
+    }
+    return 0;
+}
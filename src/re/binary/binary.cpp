@@ -0,0 +1,243 @@
+#include <re/binary/binary.h>
+
+#include <fstream>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define REX_RE_BINARY_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+using namespace rex::re;
+
+// alignment of all sections
+constexpr std::uint64_t kAlignment = 64;
+
+inline std::uint64_t Align(std::uint64_t offset) {
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// map the whole file into memory, or read it into an aligned buffer
+std::shared_ptr<const void> MapFile(const std::string &path,
+        std::size_t &size) {
+#ifdef REX_RE_BINARY_MMAP
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+    size = st.st_size;
+    auto addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    return std::shared_ptr<const void>(addr, [size](const void *ptr) {
+        munmap(const_cast<void *>(ptr), size);
+    });
+#else
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs) return nullptr;
+    size = ifs.tellg();
+    auto buffer = new std::uint64_t[(size + 7) / 8];
+    std::shared_ptr<const void> data(buffer, [](const void *ptr) {
+        delete[] static_cast<const std::uint64_t *>(ptr);
+    });
+    ifs.seekg(0);
+    if (!ifs.read(reinterpret_cast<char *>(buffer), size)) return nullptr;
+    return data;
+#endif
+}
+
+// flush the data of file to disk, returns false if failed
+bool SyncFile(const std::string &path) {
+#ifdef REX_RE_BINARY_MMAP
+    auto fd = open(path.c_str(), O_WRONLY);
+    if (fd < 0) return false;
+    auto ret = fsync(fd);
+    close(fd);
+    return !ret;
+#else
+    static_cast<void>(path);
+    return true;
+#endif
+}
+
+// check if section is in file & aligned
+inline bool CheckSection(const BinaryHeader &header, std::uint64_t offset,
+        std::uint64_t size) {
+    return offset % kAlignment == 0 && offset <= header.file_size &&
+           size <= header.file_size - offset;
+}
+
+bool CheckHeader(const BinaryHeader &header, std::size_t file_size) {
+    if (std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) ||
+            header.version != kBinaryVersion ||
+            header.byte_order != kByteOrderMark ||
+            header.header_size != sizeof(BinaryHeader) ||
+            header.file_size != file_size) {
+        return false;
+    }
+    // check layout of table
+    if (!header.state_count || !header.class_count ||
+            header.class_count > 256 || header.shift > 8 ||
+            (1ULL << header.shift) < header.class_count ||
+            header.state_count > (UINT32_MAX >> header.shift)) {
+        return false;
+    }
+    auto entry_count = header.state_count << header.shift;
+    if (header.initial >= entry_count ||
+            header.initial & ((1ULL << header.shift) - 1)) {
+        return false;
+    }
+    // check sections
+    auto accept_size = (header.state_count + 63) / 64;
+    return CheckSection(header, header.char_class_offset, 256) &&
+           CheckSection(header, header.table_offset,
+                        entry_count * sizeof(StateTable::StateId)) &&
+           CheckSection(header, header.accept_offset,
+                        accept_size * sizeof(std::uint64_t)) &&
+           CheckSection(header, header.token_offset,
+                        header.state_count * sizeof(std::int32_t)) &&
+           header.metadata_offset <= file_size &&
+           header.metadata_size <= file_size - header.metadata_offset;
+}
+
+} // namespace
+
+namespace rex::re {
+
+bool SaveStateTable(const std::string &path, const StateTable &table,
+        const std::string &metadata) {
+    auto entry_count = table.state_count() << table.shift();
+    auto accept_size = (table.state_count() + 63) / 64;
+    // get layout of file
+    BinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    header.version = kBinaryVersion;
+    header.byte_order = kByteOrderMark;
+    header.header_size = sizeof(BinaryHeader);
+    header.state_count = table.state_count();
+    header.class_count = table.class_count();
+    header.shift = table.shift();
+    header.initial = table.initial();
+    header.char_class_offset = Align(sizeof(BinaryHeader));
+    header.table_offset = Align(header.char_class_offset + 256);
+    header.accept_offset = Align(header.table_offset +
+            entry_count * sizeof(StateTable::StateId));
+    header.token_offset = Align(header.accept_offset +
+            accept_size * sizeof(std::uint64_t));
+    header.metadata_offset = Align(header.token_offset +
+            table.state_count() * sizeof(std::int32_t));
+    header.metadata_size = metadata.size();
+    header.file_size = header.metadata_offset + header.metadata_size;
+    // write all sections to a temporary file, then replace the file,
+    // so that the file mapped by other processes is never modified
+    auto temp_path = path + ".tmp";
+    std::ofstream ofs(temp_path, std::ios::binary | std::ios::trunc);
+    std::uint64_t cur_offset = 0;
+    auto Write = [&ofs, &cur_offset](std::uint64_t offset, const void *data,
+            std::uint64_t size) {
+        static const char padding[kAlignment] = {0};
+        ofs.write(padding, offset - cur_offset);
+        ofs.write(static_cast<const char *>(data), size);
+        cur_offset = offset + size;
+    };
+    Write(0, &header, sizeof(header));
+    Write(header.char_class_offset, table.char_class_data(), 256);
+    Write(header.table_offset, table.table_data(),
+          entry_count * sizeof(StateTable::StateId));
+    Write(header.accept_offset, table.accept_data(),
+          accept_size * sizeof(std::uint64_t));
+    Write(header.token_offset, table.token_data(),
+          table.state_count() * sizeof(std::int32_t));
+    Write(header.metadata_offset, metadata.data(), metadata.size());
+    ofs.close();
+    // data must be on disk before renaming, otherwise the file
+    // may be empty or partial after a crash
+    auto ok = static_cast<bool>(ofs) && SyncFile(temp_path);
+    if (!ok || std::rename(temp_path.c_str(), path.c_str())) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+StateTablePtr LoadStateTable(const std::string &path,
+        std::string *metadata) {
+    std::size_t size;
+    auto data = MapFile(path, size);
+    if (!data || size < sizeof(BinaryHeader)) return nullptr;
+    auto base = static_cast<const char *>(data.get());
+    const auto &header = *reinterpret_cast<const BinaryHeader *>(base);
+    if (!CheckHeader(header, size)) return nullptr;
+    // char classes are small, check them before using
+    auto char_class = reinterpret_cast<const std::uint8_t *>(
+            base + header.char_class_offset);
+    for (int c = 0; c < 256; ++c) {
+        if (char_class[c] >= header.class_count) return nullptr;
+    }
+    if (metadata) {
+        metadata->assign(base + header.metadata_offset,
+                         header.metadata_size);
+    }
+    // check all transitions, so that matching never reads out of table
+    auto table = reinterpret_cast<const StateTable::StateId *>(
+            base + header.table_offset);
+    auto entry_count = header.state_count << header.shift;
+    auto row_mask = (1ULL << header.shift) - 1;
+    for (std::uint64_t i = 0; i < entry_count; ++i) {
+        if (table[i] >= entry_count || (table[i] & row_mask)) return nullptr;
+    }
+    // tokens of non-final states are -1, others are non-negative
+    auto tokens = reinterpret_cast<const std::int32_t *>(
+            base + header.token_offset);
+    for (std::uint64_t i = 0; i < header.state_count; ++i) {
+        if (tokens[i] < -1) return nullptr;
+    }
+    return std::make_shared<StateTable>(header.state_count,
+            header.class_count, header.shift, header.initial, char_class,
+            table, reinterpret_cast<const std::uint64_t *>(
+                    base + header.accept_offset),
+            tokens, std::move(data));
+}
+
+bool SaveLexer(const std::string &path, const Lexer &lexer) {
+    if (!lexer.table()) return false;
+    // tokens of rules are stored as metadata
+    const auto &tokens = lexer.tokens();
+    std::string metadata(tokens.size() * sizeof(std::int32_t), 0);
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        std::int32_t token = tokens[i];
+        std::memcpy(&metadata[i * sizeof(token)], &token, sizeof(token));
+    }
+    return SaveStateTable(path, *lexer.table(), metadata);
+}
+
+LexerPtr LoadLexer(const std::string &path) {
+    std::string metadata;
+    auto table = LoadStateTable(path, &metadata);
+    if (!table || metadata.size() % sizeof(std::int32_t)) return nullptr;
+    std::vector<int> tokens(metadata.size() / sizeof(std::int32_t));
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        std::int32_t token;
+        std::memcpy(&token, &metadata[i * sizeof(token)], sizeof(token));
+        tokens[i] = token;
+    }
+    // tokens of table are indices of rules
+    for (std::size_t i = 0; i < table->state_count(); ++i) {
+        auto token = table->token_data()[i];
+        if (token >= static_cast<std::int32_t>(tokens.size())) return nullptr;
+    }
+    return std::make_shared<Lexer>(table, tokens);
+}
+
+} // namespace rex::re
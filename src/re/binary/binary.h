@@ -0,0 +1,72 @@
+#ifndef REX_RE_BINARY_BINARY_H_
+#define REX_RE_BINARY_BINARY_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/util/table.h>
+#include <re/lexer/lexer.h>
+
+// binary format of compiled automata
+//
+// file layout (all offsets are relative to the beginning of file,
+// all sections are aligned to 64 bytes):
+//   header
+//   char classes     uint8  x 256
+//   transitions      uint32 x (state_count << shift)
+//   accept bitmap    uint64 x ((state_count + 63) / 64)
+//   tokens           int32  x state_count
+//   metadata         arbitrary bytes
+//
+// NOTE:  all values are stored in native byte order, files are rejected
+//        if the byte order does not match, tables are mapped into memory
+//        and used in place without any copying
+// NOTE:  loading is not free, all char classes, transitions & tokens
+//        are scanned once to validate them, so the time of loading
+//        is linear in the size of table
+// NOTE:  files are written to 'path.tmp', flushed to disk and then
+//        renamed, so that processes that have mapped the old file are
+//        not affected, and a crash never leaves a partial file
+
+namespace rex::re {
+
+// header of binary file
+struct BinaryHeader {
+    // magic number & version of format
+    char magic[8];
+    std::uint32_t version;
+    // byte order mark, must be 'kByteOrderMark' in native byte order
+    std::uint32_t byte_order;
+    // size of header & total size of file
+    std::uint64_t header_size, file_size;
+    // layout of table
+    std::uint64_t state_count, class_count, shift, initial;
+    // offsets of sections
+    std::uint64_t char_class_offset, table_offset;
+    std::uint64_t accept_offset, token_offset;
+    std::uint64_t metadata_offset, metadata_size;
+};
+
+constexpr char kBinaryMagic[8] = {'r', 'e', 'X', 'D', 'F', 'A', 0, 0};
+constexpr std::uint32_t kBinaryVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+// write state table & metadata to file, returns false if failed
+bool SaveStateTable(const std::string &path, const StateTable &table,
+        const std::string &metadata = "");
+// map state table from file (or read it if mmap is not available),
+// returns null if the file is invalid
+StateTablePtr LoadStateTable(const std::string &path,
+        std::string *metadata = nullptr);
+
+// write the state table & tokens of lexer to file,
+// lexer must have been built
+bool SaveLexer(const std::string &path, const Lexer &lexer);
+// load lexer from file, returns null if the file is invalid
+LexerPtr LoadLexer(const std::string &path);
+
+} // namespace rex::re
+
+#endif // REX_RE_BINARY_BINARY_H_
@@ -0,0 +1,75 @@
+#include <re/cache/cache.h>
+
+#include <utility>
+
+#include <re/parser/parser.h>
+
+namespace rex::re {
+
+RegexPtr RegexCache::Get(std::string_view pattern, Regex::Engine engine) {
+    // engine is a part of key
+    std::string raw_key(pattern);
+    raw_key += '\0';
+    raw_key += static_cast<char>(engine);
+    // find raw text in cache, without parsing
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = raw_map_.find(raw_key);
+        if (it != raw_map_.end()) return Use(it->second, std::string());
+    }
+    Parser parser(pattern);
+    auto reo = parser.Parse();
+    if (!reo) return nullptr;
+    auto key = parser.normalized();
+    key += '\0';
+    key += static_cast<char>(engine);
+    // find normalized text in cache
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entry_map_.find(key);
+        if (it != entry_map_.end()) {
+            return Use(it->second, std::move(raw_key));
+        }
+    }
+    // compile & insert into cache
+    auto regex = std::make_shared<Regex>(reo, engine);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entry_map_.find(key);
+    if (it != entry_map_.end()) return Use(it->second, std::move(raw_key));
+    entries_.push_front({std::move(key), regex, {}});
+    entry_map_.insert({entries_.front().key, entries_.begin()});
+    Use(entries_.begin(), std::move(raw_key));
+    // remove the least recently used entry
+    if (entries_.size() > capacity_) {
+        const auto &entry = entries_.back();
+        for (const auto &raw : entry.raw_keys) {
+            raw_map_.erase(std::string(raw));
+        }
+        entry_map_.erase(entry.key);
+        entries_.pop_back();
+    }
+    return regex;
+}
+
+void RegexCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    raw_map_.clear();
+    entry_map_.clear();
+    entries_.clear();
+}
+
+std::size_t RegexCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+RegexPtr RegexCache::Use(EntryIt it, std::string raw_key) {
+    entries_.splice(entries_.begin(), entries_, it);
+    if (!raw_key.empty()) {
+        auto ret = raw_map_.insert({std::move(raw_key), it});
+        if (ret.second) it->raw_keys.push_back(ret.first->first);
+    }
+    return it->regex;
+}
+
+} // namespace rex::re
@@ -0,0 +1,72 @@
+#ifndef REX_RE_CACHE_CACHE_H_
+#define REX_RE_CACHE_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstddef>
+#include <cassert>
+
+#include <re/regex/regex.h>
+
+namespace rex::re {
+
+class RegexCache;
+
+using RegexCachePtr = std::shared_ptr<RegexCache>;
+
+// thread-safe LRU cache of compiled regular expressions in text form,
+// patterns are identified by their normalized texts, so the patterns
+// that only differ in writing (e.g. '[a-c]' & '[cba]') compile once
+// NOTE:  raw texts of patterns are also mapped to their entries, so
+//        patterns are only parsed if their raw texts are not cached
+// NOTE:  patterns are compiled without holding the lock, if multiple
+//        threads compile the same pattern, the first result is kept
+class RegexCache {
+public:
+    RegexCache(std::size_t capacity) : capacity_(capacity) {
+        assert(capacity_);
+    }
+    ~RegexCache() {}
+
+    // get the compiled regex of pattern, compile it if not cached,
+    // returns null if pattern is invalid
+    RegexPtr Get(std::string_view pattern,
+            Regex::Engine engine = Regex::Engine::Auto);
+    // remove all cached regexes
+    void Clear();
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        // normalized text & engine
+        std::string key;
+        RegexPtr regex;
+        // keys of 'raw_map_' that reference current entry
+        std::vector<std::string_view> raw_keys;
+    };
+    using EntryIt = std::list<Entry>::iterator;
+
+    // move entry to the front & map 'raw_key' to it if not empty,
+    // returns the regex of entry
+    // NOTE:  must be called with the lock held
+    RegexPtr Use(EntryIt it, std::string raw_key);
+
+    std::size_t capacity_;
+    mutable std::mutex mutex_;
+    // entries in the order of use, the most recently used is the first
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, EntryIt> entry_map_;
+    // raw text & engine to entries
+    std::unordered_map<std::string, EntryIt> raw_map_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_CACHE_CACHE_H_
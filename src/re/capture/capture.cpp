@@ -0,0 +1,256 @@
+#include <re/capture/capture.h>
+
+#include <utility>
+#include <algorithm>
+
+#include <re/nfa/subset.h>
+#include <re/vm/vm.h>
+
+namespace {
+
+using namespace rex::re;
+
+constexpr auto npos = std::string_view::npos;
+
+// threads of NFA simulation in the order of priority, each thread
+// is waiting on an edge with symbol, or on a final node (arc is null)
+struct ThreadList {
+    std::vector<const NFAArc *> arcs;
+    // capture slots of all threads
+    std::vector<std::size_t> slots;
+
+    void Clear() {
+        arcs.clear();
+        slots.clear();
+    }
+};
+
+// frame of the explicit stack of 'AddThread'
+struct Frame {
+    enum class Action { Visit, Restore, AddArc } action;
+    NFAIndex node, tag;
+    std::size_t old;
+    const NFAArc *arc;
+};
+
+using Action = Frame::Action;
+
+// visit node & nodes that reachable by epsilon edges in the order of
+// priority, and add threads with current capture slots,
+// 'slots' is modified while visiting, and restored before returning
+// NOTE:  'frames' is only a scratch buffer, which is reused by all
+//        calls, so that no memory will be allocated in steps
+void AddThread(const NFAModel &nfa, SparseSet &visited,
+        std::vector<Frame> &frames, ThreadList &threads, NFAIndex node,
+        std::size_t *slots, std::size_t slot_count, std::size_t pos) {
+    frames.clear();
+    frames.push_back({Action::Visit, node, kNFANone, 0, nullptr});
+    while (!frames.empty()) {
+        auto frame = frames.back();
+        frames.pop_back();
+        if (frame.action == Action::Restore) {
+            // restore the slot after visiting a tagged edge
+            slots[frame.tag] = frame.old;
+            continue;
+        }
+        if (frame.action == Action::AddArc) {
+            threads.arcs.push_back(frame.arc);
+            threads.slots.insert(threads.slots.end(),
+                                 slots, slots + slot_count);
+            continue;
+        }
+        if (frame.tag != kNFANone) slots[frame.tag] = pos;
+        if (!visited.Insert(frame.node)) continue;
+        if (nfa.token(frame.node) >= 0) {
+            threads.arcs.push_back(nullptr);
+            threads.slots.insert(threads.slots.end(),
+                                 slots, slots + slot_count);
+        }
+        // push in reverse order, so that the first edge is visited first
+        for (auto arc = nfa.arc_end(frame.node);
+                arc != nfa.arc_begin(frame.node);) {
+            --arc;
+            if (arc->symbol != kNFANone) {
+                frames.push_back({Action::AddArc, kNFANone, kNFANone, 0,
+                                  arc});
+                continue;
+            }
+            auto tag = nfa.arc_tag(arc);
+            if (tag != kNFANone) {
+                frames.push_back({Action::Restore, kNFANone, tag,
+                                  slots[tag], nullptr});
+            }
+            frames.push_back({Action::Visit, arc->tail, tag, 0, nullptr});
+        }
+    }
+}
+
+} // namespace
+
+namespace rex::re {
+
+CaptureRegex::CaptureRegex(const REObject &reo)
+        : nfa_(reo->GenerateNFA()), group_count_(1),
+          one_pass_(false), class_count_(0), start_(0) {
+    nfa_->NormalizeNFA();
+    // get count of groups from tags
+    entry_tag_ = nfa_->edge_tag(nfa_->entry());
+    if (entry_tag_ != kNFANone) {
+        group_count_ = std::max<std::size_t>(group_count_, entry_tag_ / 2 + 1);
+    }
+    for (NFAIndex node = 0; node < nfa_->node_count(); ++node) {
+        for (auto arc = nfa_->arc_begin(node);
+                arc != nfa_->arc_end(node); ++arc) {
+            auto tag = nfa_->arc_tag(arc);
+            if (tag == kNFANone) continue;
+            group_count_ = std::max<std::size_t>(group_count_, tag / 2 + 1);
+        }
+    }
+    one_pass_ = BuildOnePass();
+    if (!one_pass_) {
+        decltype(table_)().swap(table_);
+        decltype(final_actions_)().swap(final_actions_);
+        decltype(actions_)().swap(actions_);
+    }
+}
+
+std::uint32_t CaptureRegex::AddActions(const std::vector<NFAIndex> &tags) {
+    auto it = std::find(actions_.begin(), actions_.end(), tags);
+    if (it != actions_.end()) return it - actions_.begin();
+    actions_.push_back(tags);
+    return actions_.size() - 1;
+}
+
+bool CaptureRegex::BuildOnePass() {
+    const auto &nfa = *nfa_;
+    NFAAlphabet alphabet(nfa);
+    char_class_ = alphabet.char_class();
+    class_count_ = alphabet.class_count();
+    // states of DFA are the start node & the nodes that reached by chars
+    std::vector<std::int64_t> state_ids(nfa.node_count(), -1);
+    std::vector<NFAIndex> states = {nfa.start()};
+    state_ids[nfa.start()] = 0;
+    std::vector<std::size_t> visited(nfa.node_count(), npos);
+    actions_.assign(1, {});
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        table_.resize((i + 1) * class_count_, {0, 0});
+        final_actions_.push_back(-1);
+        // visit all nodes in epsilon closure, with the tags on the path
+        struct Frame {
+            NFAIndex node;
+            std::vector<NFAIndex> tags;
+        };
+        std::vector<Frame> frames = {{states[i], {}}};
+        while (!frames.empty()) {
+            auto frame = std::move(frames.back());
+            frames.pop_back();
+            // node can be reached by multiple paths, not one-pass
+            if (visited[frame.node] == i) return false;
+            visited[frame.node] = i;
+            if (nfa.token(frame.node) >= 0) {
+                if (final_actions_[i] >= 0) return false;
+                final_actions_[i] = AddActions(frame.tags);
+            }
+            for (auto arc = nfa.arc_begin(frame.node);
+                    arc != nfa.arc_end(frame.node); ++arc) {
+                if (arc->symbol == kNFANone) {
+                    auto tags = frame.tags;
+                    auto tag = nfa.arc_tag(arc);
+                    if (tag != kNFANone) tags.push_back(tag);
+                    frames.push_back({arc->tail, std::move(tags)});
+                    continue;
+                }
+                // add transitions, each char must lead to only one path
+                auto &id = state_ids[arc->tail];
+                if (id < 0) {
+                    id = states.size();
+                    states.push_back(arc->tail);
+                }
+                auto actions = AddActions(frame.tags);
+                const auto &symbol = nfa.symbol(arc->symbol);
+                for (std::size_t cls = 0; cls < class_count_; ++cls) {
+                    if (!symbol->TestChar(char_class_.GetRepresentative(cls))) {
+                        continue;
+                    }
+                    auto &trans = table_[i * class_count_ + cls];
+                    if (trans.next) return false;
+                    trans = {static_cast<std::uint32_t>(id + 1), actions};
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool CaptureRegex::ExtractOnePass(std::string_view str,
+        std::vector<std::size_t> &slots) const {
+    auto state = start_;
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        auto cls = char_class_.GetClass(str[i]);
+        const auto &trans = table_[state * class_count_ + cls];
+        if (!trans.next) return false;
+        for (const auto &tag : actions_[trans.actions]) slots[tag] = i;
+        state = trans.next - 1;
+    }
+    auto actions = final_actions_[state];
+    if (actions < 0) return false;
+    for (const auto &tag : actions_[actions]) slots[tag] = str.size();
+    return true;
+}
+
+bool CaptureRegex::ExtractNFA(std::string_view str,
+        std::vector<std::size_t> &slots) const {
+    const auto &nfa = *nfa_;
+    auto slot_count = slots.size();
+    SparseSet visited(nfa.node_count());
+    std::vector<Frame> frames;
+    ThreadList cur, next;
+    AddThread(nfa, visited, frames, cur, nfa.start(), slots.data(),
+            slot_count, 0);
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        // step all threads in the order of priority, slots of current
+        // threads are not used after stepping, so they are modified
+        // in place instead of being copied
+        visited.Clear();
+        next.Clear();
+        for (std::size_t t = 0; t < cur.arcs.size(); ++t) {
+            auto arc = cur.arcs[t];
+            if (!arc || !nfa.symbol(arc->symbol)->TestChar(str[i])) continue;
+            AddThread(nfa, visited, frames, next, arc->tail,
+                    cur.slots.data() + t * slot_count, slot_count, i + 1);
+        }
+        std::swap(cur, next);
+        if (cur.arcs.empty()) return false;
+    }
+    // pick the final thread with the highest priority
+    for (std::size_t t = 0; t < cur.arcs.size(); ++t) {
+        if (cur.arcs[t]) continue;
+        auto begin = cur.slots.begin() + t * slot_count;
+        std::copy(begin, begin + slot_count, slots.begin());
+        return true;
+    }
+    return false;
+}
+
+bool CaptureRegex::Extract(std::string_view str,
+        std::vector<Match> &groups) const {
+    std::vector<std::size_t> slots(group_count_ * 2, npos);
+    if (entry_tag_ != kNFANone) slots[entry_tag_] = 0;
+    auto matched = one_pass_ ? ExtractOnePass(str, slots)
+                             : ExtractNFA(str, slots);
+    if (!matched) return false;
+    groups.resize(group_count_);
+    groups[0] = {0, str.size()};
+    for (std::size_t i = 1; i < group_count_; ++i) {
+        auto begin = slots[i * 2], end = slots[i * 2 + 1];
+        if (begin != npos && end != npos) {
+            groups[i] = {begin, end - begin};
+        }
+        else {
+            groups[i] = {npos, 0};
+        }
+    }
+    return true;
+}
+
+} // namespace rex::re
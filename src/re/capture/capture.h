@@ -0,0 +1,80 @@
+#ifndef REX_RE_CAPTURE_CAPTURE_H_
+#define REX_RE_CAPTURE_CAPTURE_H_
+
+#include <memory>
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/reobj/reobj.h>
+#include <re/nfa/nfa.h>
+#include <re/util/charclass.h>
+#include <re/search/search.h>
+
+namespace rex::re {
+
+class CaptureRegex;
+
+using CaptureRegexPtr = std::shared_ptr<CaptureRegex>;
+
+// regular expression that extracts the submatches of capture groups
+// NOTE:  if the pattern is one-pass (the next char always decides the
+//        path in NFA), submatches will be extracted by a one-pass DFA,
+//        otherwise by NFA simulation with capture slots, both engines
+//        scan the input only once without backtracking
+// NOTE:  if there are multiple ways to match, the left alternative is
+//        preferred and repetitions are greedy, a group in repetition
+//        holds the submatch of the last iteration
+class CaptureRegex {
+public:
+    CaptureRegex(const REObject &reo);
+    ~CaptureRegex() {}
+
+    // match the whole string, and get the submatches of all groups,
+    // group 0 is the whole string, and groups that did not participate
+    // in the match will be '{npos, 0}'
+    bool Extract(std::string_view str, std::vector<Match> &groups) const;
+
+    // count of groups, including group 0
+    std::size_t group_count() const { return group_count_; }
+    // check if one-pass DFA is used
+    bool one_pass() const { return one_pass_; }
+
+private:
+    // transition of one-pass DFA
+    struct Transition {
+        // index of next state plus one, 0 if there is no transition
+        std::uint32_t next;
+        // index of actions, which record current position to tags
+        std::uint32_t actions;
+    };
+
+    // try to build one-pass DFA, returns false if pattern is not one-pass
+    bool BuildOnePass();
+    // get index of actions
+    std::uint32_t AddActions(const std::vector<NFAIndex> &tags);
+    // match by one-pass DFA or NFA simulation, fill capture slots
+    bool ExtractOnePass(std::string_view str,
+            std::vector<std::size_t> &slots) const;
+    bool ExtractNFA(std::string_view str,
+            std::vector<std::size_t> &slots) const;
+
+    NFAModelPtr nfa_;
+    std::size_t group_count_;
+    // tag of the entry edge of NFA
+    NFAIndex entry_tag_;
+    bool one_pass_;
+    // one-pass DFA
+    CharClassMap char_class_;
+    std::size_t class_count_;
+    std::vector<Transition> table_;
+    // actions when the input ends at each state, -1 if not final
+    std::vector<std::int64_t> final_actions_;
+    std::vector<std::vector<NFAIndex>> actions_;
+    std::uint32_t start_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_CAPTURE_CAPTURE_H_
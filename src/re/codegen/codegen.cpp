@@ -0,0 +1,256 @@
+#include <re/codegen/codegen.h>
+
+#include <utility>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <cstdint>
+
+namespace {
+
+// transition from a state to another state
+struct Branch {
+    std::size_t next;
+    // bytes on transition, as inclusive ranges & bit mask
+    std::vector<std::pair<int, int>> ranges;
+    std::uint64_t mask[4];
+    std::size_t size;
+    // index of bit mask in generated code, or -1 if not used
+    int mask_id;
+};
+
+std::string GetCharLiteral(int c) {
+    std::ostringstream oss;
+    if (std::isalnum(c) || (std::ispunct(c) && c != '\'' && c != '\\')) {
+        oss << '\'' << static_cast<char>(c) << '\'';
+    }
+    else {
+        oss << "0x" << std::hex << std::setw(2) << std::setfill('0') << c;
+    }
+    return oss.str();
+}
+
+std::string GetCondition(const Branch &branch) {
+    if (branch.mask_id >= 0) {
+        std::ostringstream oss;
+        oss << "(mask" << branch.mask_id << "[c >> 6] >> (c & 63)) & 1";
+        return oss.str();
+    }
+    std::string cond;
+    for (const auto &range : branch.ranges) {
+        if (!cond.empty()) cond += " || ";
+        if (range.first == range.second) {
+            cond += "c == " + GetCharLiteral(range.first);
+        }
+        else if (!range.first || range.second == 0xff) {
+            // bounds of unsigned char are always true
+            cond += range.first ? "c >= " + GetCharLiteral(range.first)
+                                : "c <= " + GetCharLiteral(range.second);
+        }
+        else {
+            auto paren = branch.ranges.size() > 1;
+            if (paren) cond += "(";
+            cond += "c >= " + GetCharLiteral(range.first) + " && c <= " +
+                    GetCharLiteral(range.second);
+            if (paren) cond += ")";
+        }
+    }
+    return cond;
+}
+
+// check if the only branch takes all bytes
+bool IsUnconditional(const std::vector<Branch> &branches) {
+    return branches.size() == 1 && branches.front().size == 256;
+}
+
+// dispatch by 'switch' if there are many branches with few bytes
+bool IsSwitch(const std::vector<Branch> &branches) {
+    using rex::re::CodeGen;
+    std::size_t case_count = 0;
+    for (const auto &branch : branches) case_count += branch.size;
+    return branches.size() >= CodeGen::kMinSwitchBranches &&
+           case_count <= CodeGen::kMaxSwitchCases;
+}
+
+} // namespace
+
+namespace rex::re {
+
+bool CodeGen::GenerateStates(std::ostream &os, bool lexer) const {
+    const auto &table = *table_;
+    // find all reachable states
+    auto initial = table.GetStateIndex(table.initial());
+    std::vector<std::size_t> states = {initial};
+    std::vector<bool> visited(table.state_count(), false);
+    std::vector<bool> targeted(table.state_count(), false);
+    visited[0] = visited[initial] = true;
+    std::vector<std::vector<Branch>> branches;
+    int mask_count = 0;
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        auto state = table.GetState(states[i]);
+        // group bytes by next state
+        auto &cur_branches = branches.emplace_back();
+        for (int c = 0; c < 256; ++c) {
+            auto next = table.GetStateIndex(table.Next(state, c));
+            if (!next) continue;
+            auto it = std::find_if(cur_branches.begin(), cur_branches.end(),
+                    [next](const Branch &b) { return b.next == next; });
+            if (it == cur_branches.end()) {
+                cur_branches.push_back({next, {}, {0, 0, 0, 0}, 0, -1});
+                it = cur_branches.end() - 1;
+            }
+            if (!it->ranges.empty() && it->ranges.back().second == c - 1) {
+                it->ranges.back().second = c;
+            }
+            else {
+                it->ranges.push_back({c, c});
+            }
+            it->mask[c / 64] |= 1ULL << (c % 64);
+            ++it->size;
+            targeted[next] = true;
+            if (!visited[next]) {
+                visited[next] = true;
+                states.push_back(next);
+            }
+        }
+        // check the branches that take more bytes first
+        std::stable_sort(cur_branches.begin(), cur_branches.end(),
+                [](const Branch &l, const Branch &r) {
+                    return l.size > r.size;
+                });
+        // bit masks are not used if dispatching by 'switch'
+        if (IsSwitch(cur_branches)) continue;
+        for (auto &&branch : cur_branches) {
+            if (branch.ranges.size() > kMaxRanges) {
+                branch.mask_id = mask_count++;
+            }
+        }
+    }
+    // generate bit masks
+    for (const auto &cur_branches : branches) {
+        for (const auto &branch : cur_branches) {
+            if (branch.mask_id < 0) continue;
+            os << "    static const std::uint64_t mask" << branch.mask_id
+               << "[4] = {";
+            for (int i = 0; i < 4; ++i) {
+                os << (i ? ", " : "") << "0x" << std::hex
+                   << branch.mask[i] << std::dec << "ULL";
+            }
+            os << "};\n";
+        }
+    }
+    // generate states, the initial state is the first one,
+    // bytes are only stored if some state checks them
+    auto checks = std::any_of(branches.begin(), branches.end(),
+            [](const std::vector<Branch> &b) {
+                return !b.empty() && !IsUnconditional(b);
+            });
+    if (checks) os << "    unsigned c;\n";
+    bool reads = false;
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        auto state = table.GetState(states[i]);
+        auto accept = table.IsAccept(state);
+        const auto &cur_branches = branches[i];
+        // lexer does not accept empty tokens, initial state is
+        // only accepted when it is reached by transitions
+        auto entry = !i && lexer && accept && targeted[states[i]];
+        if (entry) os << "    goto start;\n";
+        if (targeted[states[i]]) os << "s" << states[i] << ":\n";
+        if (lexer && accept && (i || entry)) {
+            auto token = table.GetToken(state);
+            if (!tokens_.empty()) token = tokens_[token];
+            os << "    token = " << token << ";\n";
+            os << "    last = p;\n";
+        }
+        if (entry) os << "start:\n";
+        // action when input ends or transition fails
+        std::string stop = "goto done;";
+        if (!lexer) stop = accept ? "return true;" : "return false;";
+        if (cur_branches.empty()) {
+            if (lexer) {
+                os << "    goto done;\n";
+            }
+            else {
+                os << "    return " << (accept ? "p == end" : "false")
+                   << ";\n";
+            }
+            continue;
+        }
+        reads = true;
+        os << "    if (p == end) " << stop << "\n";
+        if (IsUnconditional(cur_branches)) {
+            os << "    ++p;\n";
+            os << "    goto s" << cur_branches.front().next << ";\n";
+            continue;
+        }
+        os << "    c = *p++;\n";
+        if (!lexer) stop = "return false;";
+        if (IsSwitch(cur_branches)) {
+            os << "    switch (c) {\n";
+            for (const auto &branch : cur_branches) {
+                for (const auto &range : branch.ranges) {
+                    for (auto c = range.first; c <= range.second; ++c) {
+                        os << "        case " << GetCharLiteral(c) << ":\n";
+                    }
+                }
+                os << "            goto s" << branch.next << ";\n";
+            }
+            os << "        default:\n";
+            os << "            " << stop << "\n";
+            os << "    }\n";
+            continue;
+        }
+        // dispatch by range compares & bit tests
+        for (const auto &branch : cur_branches) {
+            os << "    if (" << GetCondition(branch) << ") goto s"
+               << branch.next << ";\n";
+        }
+        os << "    " << stop << "\n";
+    }
+    return reads;
+}
+
+void CodeGen::GenerateMatcher(std::ostream &os,
+        const std::string &name) const {
+    os << "#include <cstddef>\n";
+    os << "#include <cstdint>\n\n";
+    os << "// generated by reX, do not edit\n";
+    os << "bool " << name << "(const char *str, std::size_t len) {\n";
+    os << "    auto p = reinterpret_cast<const unsigned char *>(str);\n";
+    os << "    const auto end = p + len;\n";
+    GenerateStates(os, false);
+    os << "}\n";
+}
+
+void CodeGen::GenerateLexer(std::ostream &os,
+        const std::string &name) const {
+    os << "#include <cstddef>\n";
+    os << "#include <cstdint>\n\n";
+    os << "// generated by reX, do not edit\n";
+    os << "int " << name << "(const char *str, std::size_t len, "
+       << "std::size_t &token_len) {\n";
+    os << "    const auto begin = reinterpret_cast<const unsigned char *>"
+       << "(str);\n";
+    // cursor is only declared if some state reads input
+    std::ostringstream states;
+    if (GenerateStates(states, true)) {
+        os << "    const auto end = begin + len;\n";
+        os << "    auto p = begin, last = begin;\n";
+    }
+    else {
+        os << "    auto last = begin;\n";
+    }
+    os << "    int token = -1;\n";
+    os << states.str();
+    os << "done:\n";
+    os << "    if (token < 0) {\n";
+    os << "        token_len = len ? 1 : 0;\n";
+    os << "        return -1;\n";
+    os << "    }\n";
+    os << "    token_len = last - begin;\n";
+    os << "    return token;\n";
+    os << "}\n";
+}
+
+} // namespace rex::re
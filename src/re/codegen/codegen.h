@@ -0,0 +1,59 @@
+#ifndef REX_RE_CODEGEN_CODEGEN_H_
+#define REX_RE_CODEGEN_CODEGEN_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+#include <re/dfa/dfa.h>
+#include <re/util/table.h>
+
+namespace rex::re {
+
+class CodeGen;
+
+using CodeGenPtr = std::shared_ptr<CodeGen>;
+
+// generator of direct-coded C++ matchers, each state of DFA becomes
+// a label, and transitions become range compares, bit tests or 'switch'
+// NOTE:  generated code only depends on the standard library
+class CodeGen {
+public:
+    // transitions with more ranges of bytes will be checked by bit tests
+    static constexpr std::size_t kMaxRanges = 3;
+    // states with at least this many transitions & at most this many
+    // bytes on transitions will dispatch by 'switch'
+    static constexpr std::size_t kMinSwitchBranches = 4;
+    static constexpr std::size_t kMaxSwitchCases = 64;
+
+    CodeGen(const StateTablePtr &table) : table_(table) {}
+    CodeGen(const DFAModelPtr &dfa) : table_(dfa->GenerateStateTable()) {}
+    ~CodeGen() {}
+
+    // generate 'bool name(const char *str, std::size_t len)',
+    // which tests if the whole string is matched
+    void GenerateMatcher(std::ostream &os, const std::string &name) const;
+    // generate 'int name(const char *str, std::size_t len,
+    // std::size_t &token_len)', which reads the longest token from
+    // the beginning of input like 'Lexer::ReadToken', returns -1
+    // with length 1 if no rule matches
+    void GenerateLexer(std::ostream &os, const std::string &name) const;
+
+    // map from tokens of DFA to tokens returned by generated lexer,
+    // e.g. 'Lexer::tokens()' since tokens of lexer DFA are rule indices
+    void set_tokens(const std::vector<int> &tokens) { tokens_ = tokens; }
+
+private:
+    // generate bit masks & labels of all reachable states,
+    // returns false if no state reads input
+    bool GenerateStates(std::ostream &os, bool lexer) const;
+
+    StateTablePtr table_;
+    std::vector<int> tokens_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_CODEGEN_CODEGEN_H_
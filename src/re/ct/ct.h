@@ -0,0 +1,347 @@
+#ifndef REX_RE_CT_CT_H_
+#define REX_RE_CT_CT_H_
+
+#include <array>
+#include <string_view>
+#include <type_traits>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/util/table.h>
+
+// compile-time regular expressions, patterns are built by the same
+// combinators as 'REObject' in constant expressions, and compiled
+// into DFA tables by the compiler, e.g.
+//
+//   static constexpr auto kIdent =
+//       ct::Range('a', 'z') & (ct::Range('a', 'z') | ct::Word("_")).Many();
+//   bool ok = ct::Match<kIdent>(str);
+//
+// NOTE:  patterns are represented by Glushkov automata (each char of
+//        pattern is a position), so all combinators work without any
+//        dynamic allocation, DFA is generated by subset construction
+//        over sets of positions, but it will not be minimized
+
+namespace rex::re::ct {
+
+// set of byte values
+struct ByteSet {
+    std::array<std::uint64_t, 4> bits = {};
+
+    constexpr void Insert(unsigned c) { bits[c / 64] |= 1ULL << (c % 64); }
+    constexpr bool Include(unsigned c) const {
+        return bits[c / 64] & (1ULL << (c % 64));
+    }
+};
+
+// set of positions
+template <std::size_t N>
+struct PosSet {
+    std::array<std::uint64_t, N / 64 + 1> bits = {};
+
+    constexpr void Insert(std::size_t pos) {
+        bits[pos / 64] |= 1ULL << (pos % 64);
+    }
+    constexpr bool Include(std::size_t pos) const {
+        return bits[pos / 64] & (1ULL << (pos % 64));
+    }
+    // merge the positions of 'set', with all positions added by 'offset'
+    template <std::size_t M>
+    constexpr void Merge(const PosSet<M> &set, std::size_t offset = 0) {
+        for (std::size_t i = 0; i < M; ++i) {
+            if (set.Include(i)) Insert(i + offset);
+        }
+    }
+    constexpr bool Empty() const {
+        for (const auto &i : bits) {
+            if (i) return false;
+        }
+        return true;
+    }
+    constexpr bool operator==(const PosSet &rhs) const {
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            if (bits[i] != rhs.bits[i]) return false;
+        }
+        return true;
+    }
+};
+
+// pattern with 'N' positions
+template <std::size_t N>
+struct Pattern {
+    // bytes accepted by each position
+    std::array<ByteSet, N> symbols = {};
+    // positions that can be matched first & last,
+    // and the positions that can be matched after each position
+    PosSet<N> first, last;
+    std::array<PosSet<N>, N> follow = {};
+    // pattern can match empty string
+    bool nullable = false;
+
+    constexpr Pattern Many() const {
+        auto ret = Many1();
+        ret.nullable = true;
+        return ret;
+    }
+
+    constexpr Pattern Many1() const {
+        auto ret = *this;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (last.Include(i)) ret.follow[i].Merge(first);
+        }
+        return ret;
+    }
+
+    constexpr Pattern Optional() const {
+        auto ret = *this;
+        ret.nullable = true;
+        return ret;
+    }
+};
+
+constexpr Pattern<0> Nil() {
+    Pattern<0> ret;
+    ret.nullable = true;
+    return ret;
+}
+
+template <std::size_t L>
+constexpr Pattern<L - 1> Word(const char (&word)[L]) {
+    Pattern<L - 1> ret;
+    for (std::size_t i = 0; i < L - 1; ++i) {
+        ret.symbols[i].Insert(static_cast<std::uint8_t>(word[i]));
+        if (i) ret.follow[i - 1].Insert(i);
+    }
+    if constexpr (L > 1) {
+        ret.first.Insert(0);
+        ret.last.Insert(L - 2);
+    }
+    ret.nullable = L == 1;
+    return ret;
+}
+
+template <typename Func>
+constexpr Pattern<1> Lambda(Func func) {
+    Pattern<1> ret;
+    for (int c = 0; c < 256; ++c) {
+        if (func(static_cast<char>(c))) ret.symbols[0].Insert(c);
+    }
+    ret.first.Insert(0);
+    ret.last.Insert(0);
+    return ret;
+}
+
+constexpr Pattern<1> Range(char c1, char c2) {
+    return Lambda([c1, c2](char c) { return c1 <= c && c <= c2; });
+}
+
+template <std::size_t N, std::size_t M>
+constexpr Pattern<N + M> And(const Pattern<N> &lhs, const Pattern<M> &rhs) {
+    Pattern<N + M> ret;
+    for (std::size_t i = 0; i < N; ++i) {
+        ret.symbols[i] = lhs.symbols[i];
+        ret.follow[i].Merge(lhs.follow[i]);
+        // positions of rhs can be matched after the last of lhs
+        if (lhs.last.Include(i)) ret.follow[i].Merge(rhs.first, N);
+    }
+    for (std::size_t i = 0; i < M; ++i) {
+        ret.symbols[N + i] = rhs.symbols[i];
+        ret.follow[N + i].Merge(rhs.follow[i], N);
+    }
+    ret.first.Merge(lhs.first);
+    if (lhs.nullable) ret.first.Merge(rhs.first, N);
+    ret.last.Merge(rhs.last, N);
+    if (rhs.nullable) ret.last.Merge(lhs.last);
+    ret.nullable = lhs.nullable && rhs.nullable;
+    return ret;
+}
+
+template <std::size_t N, std::size_t M>
+constexpr Pattern<N + M> Or(const Pattern<N> &lhs, const Pattern<M> &rhs) {
+    Pattern<N + M> ret;
+    for (std::size_t i = 0; i < N; ++i) {
+        ret.symbols[i] = lhs.symbols[i];
+        ret.follow[i].Merge(lhs.follow[i]);
+    }
+    for (std::size_t i = 0; i < M; ++i) {
+        ret.symbols[N + i] = rhs.symbols[i];
+        ret.follow[N + i].Merge(rhs.follow[i], N);
+    }
+    ret.first.Merge(lhs.first);
+    ret.first.Merge(rhs.first, N);
+    ret.last.Merge(lhs.last);
+    ret.last.Merge(rhs.last, N);
+    ret.nullable = lhs.nullable || rhs.nullable;
+    return ret;
+}
+
+template <std::size_t N>
+constexpr Pattern<N> Many(const Pattern<N> &pat) { return pat.Many(); }
+
+template <std::size_t N>
+constexpr Pattern<N> Many1(const Pattern<N> &pat) { return pat.Many1(); }
+
+template <std::size_t N>
+constexpr Pattern<N> Optional(const Pattern<N> &pat) {
+    return pat.Optional();
+}
+
+template <std::size_t N, std::size_t M>
+constexpr Pattern<N + M> operator&(const Pattern<N> &lhs,
+        const Pattern<M> &rhs) {
+    return And(lhs, rhs);
+}
+
+template <std::size_t N, std::size_t M>
+constexpr Pattern<N + M> operator|(const Pattern<N> &lhs,
+        const Pattern<M> &rhs) {
+    return Or(lhs, rhs);
+}
+
+// dense transition table of DFA with 'S' states & 'C' char classes
+// NOTE:  same layout as 'StateTable', state 0 is the dead state,
+//        and states are stored as pre-multiplied row offsets
+template <std::size_t S, std::size_t C>
+struct Table {
+    using StateId = std::conditional_t<(S * C <= 0xffff),
+                                       std::uint16_t, std::uint32_t>;
+
+    std::array<std::uint8_t, 256> char_class = {};
+    std::array<StateId, S * C> next = {};
+    std::array<bool, S> accept = {};
+    StateId initial = 0;
+
+    constexpr bool TestString(std::string_view str) const {
+        auto state = initial;
+        for (const auto &c : str) {
+            state = next[state + char_class[static_cast<std::uint8_t>(c)]];
+            if (!state) return false;
+        }
+        return accept[state / C];
+    }
+
+    // convert to the state table of runtime engines
+    StateTablePtr GenerateStateTable() const {
+        auto table = std::make_shared<StateTable>(S, C);
+        for (int c = 0; c < 256; ++c) table->SetCharClass(c, char_class[c]);
+        for (std::size_t i = 0; i < S; ++i) {
+            for (std::size_t cls = 0; cls < C; ++cls) {
+                table->SetTransition(i, cls, next[i * C + cls] / C);
+            }
+            if (accept[i]) table->SetAccept(i);
+        }
+        table->set_initial(initial / C);
+        return table;
+    }
+};
+
+// char classes of pattern
+struct ClassMap {
+    std::array<std::uint8_t, 256> classes = {};
+    std::array<std::uint8_t, 256> representatives = {};
+    std::size_t count = 0;
+};
+
+template <std::size_t N>
+constexpr ClassMap GetClassMap(const Pattern<N> &pat) {
+    // bytes are in the same class if they are accepted by same positions
+    ClassMap map;
+    std::array<PosSet<N>, 256> signatures = {};
+    for (int c = 0; c < 256; ++c) {
+        for (std::size_t i = 0; i < N; ++i) {
+            if (pat.symbols[i].Include(c)) signatures[c].Insert(i);
+        }
+        std::size_t cls = 0;
+        while (cls < map.count &&
+                !(signatures[map.representatives[cls]] == signatures[c])) {
+            ++cls;
+        }
+        if (cls == map.count) map.representatives[map.count++] = c;
+        map.classes[c] = cls;
+    }
+    return map;
+}
+
+// subset construction over sets of positions, calls 'on_state' with
+// the index & acceptance of each state, and 'on_edge' with each
+// transition, returns state count, or 'MaxStates + 1' if overflowed
+// NOTE:  position 'N' stands for the start of pattern
+template <std::size_t MaxStates, std::size_t N,
+          typename StateHandler, typename EdgeHandler>
+constexpr std::size_t GenerateStates(const Pattern<N> &pat,
+        const ClassMap &map, StateHandler on_state, EdgeHandler on_edge) {
+    std::array<PosSet<N + 1>, MaxStates> sets = {};
+    std::size_t count = 2;
+    sets[1].Insert(N);
+    for (std::size_t i = 1; i < count; ++i) {
+        const auto &set = sets[i];
+        // get the positions that can be matched after current state
+        PosSet<N + 1> follow;
+        bool accept = set.Include(N) && pat.nullable;
+        if (set.Include(N)) follow.Merge(pat.first);
+        for (std::size_t pos = 0; pos < N; ++pos) {
+            if (!set.Include(pos)) continue;
+            follow.Merge(pat.follow[pos]);
+            if (pat.last.Include(pos)) accept = true;
+        }
+        on_state(i, accept);
+        for (std::size_t cls = 0; cls < map.count; ++cls) {
+            PosSet<N + 1> next;
+            auto c = map.representatives[cls];
+            for (std::size_t pos = 0; pos < N; ++pos) {
+                if (follow.Include(pos) && pat.symbols[pos].Include(c)) {
+                    next.Insert(pos);
+                }
+            }
+            std::size_t id = 0;
+            while (id < count && !(sets[id] == next)) ++id;
+            if (id == count) {
+                if (count == MaxStates) return MaxStates + 1;
+                sets[count++] = next;
+            }
+            on_edge(i, cls, id);
+        }
+    }
+    return count;
+}
+
+// DFA with more states can not be generated by default
+constexpr std::size_t kDefaultMaxStates = 256;
+
+template <const auto &Pat, std::size_t MaxStates = kDefaultMaxStates>
+constexpr auto Compile() {
+    constexpr auto map = GetClassMap(Pat);
+    constexpr auto state_count = GenerateStates<MaxStates>(Pat, map,
+            [](std::size_t, bool) {},
+            [](std::size_t, std::size_t, std::size_t) {});
+    static_assert(state_count <= MaxStates, "too many DFA states");
+    constexpr auto class_count = map.count;
+    Table<state_count, class_count> table;
+    using StateId = typename decltype(table)::StateId;
+    for (int c = 0; c < 256; ++c) table.char_class[c] = map.classes[c];
+    GenerateStates<MaxStates>(Pat, map,
+            [&table](std::size_t state, bool accept) {
+                table.accept[state] = accept;
+            },
+            [&table](std::size_t state, std::size_t cls, std::size_t next) {
+                table.next[state * class_count + cls] =
+                        static_cast<StateId>(next * class_count);
+            });
+    table.initial = class_count;
+    return table;
+}
+
+// DFA table of pattern, generated at compile time
+template <const auto &Pat>
+inline constexpr auto kTable = Compile<Pat>();
+
+// test if the whole string is matched by pattern
+template <const auto &Pat>
+constexpr bool Match(std::string_view str) {
+    return kTable<Pat>.TestString(str);
+}
+
+} // namespace rex::re::ct
+
+#endif // REX_RE_CT_CT_H_
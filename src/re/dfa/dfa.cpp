@@ -1,9 +1,10 @@
 #include <re/dfa/dfa.h>
 #include <re/util/util.h>
 
-#include <deque>
+#include <vector>
 #include <unordered_map>
 #include <utility>
+#include <cstdint>
 
 #if NDEBUG
 #else
@@ -14,160 +15,106 @@ namespace {
 
 // re-define types in 'namespace rex'
 using DFAStatePtr = rex::re::DFAStatePtr;
-using DFAStateSet = std::unordered_set<DFAStatePtr>;
+using SymbolPtr = rex::re::SymbolPtr;
 
-using PosHash = std::size_t;
-using DFAHashMap = std::unordered_map<PosHash, DFAStateSet>;
-using SetQueue = std::deque<DFAStateSet>;
-using StateMap = std::unordered_map<DFAStatePtr, DFAStatePtr>;
-using EdgeMap = std::unordered_map<rex::re::SymbolPtr, rex::re::DFAEdgePtr>;
+// index of DFA states in minimization
+using StateIndex = std::uint32_t;
 
-// insert state into hash map
-inline void InsertIntoMap(DFAHashMap &hash_map, PosHash hash,
-        const DFAStatePtr &state) {
-    auto ret = hash_map.insert({hash, {state}});
-    if (!ret.second) {
-        ret.first->second.insert(state);
+// partition of DFA states for refinement
+// NOTE:  states of a block are stored contiguously in 'elems_',
+//        marked states are moved to the front of their block
+class Partition {
+public:
+    // initialize blocks, states with the same label are in the same block
+    Partition(const std::vector<std::size_t> &labels)
+            : elems_(labels.size()), loc_(labels.size()),
+              block_of_(labels.size()) {
+        std::unordered_map<std::size_t, std::size_t> label_block;
+        std::vector<std::size_t> counts;
+        for (StateIndex i = 0; i < labels.size(); ++i) {
+            auto ret = label_block.insert({labels[i], counts.size()});
+            if (ret.second) counts.push_back(0);
+            block_of_[i] = ret.first->second;
+            ++counts[block_of_[i]];
+        }
+        std::size_t pos = 0;
+        for (const auto &count : counts) {
+            first_.push_back(pos);
+            mid_.push_back(pos);
+            pos += count;
+            end_.push_back(pos);
+        }
+        for (StateIndex i = 0; i < labels.size(); ++i) {
+            auto &cur_pos = mid_[block_of_[i]];
+            elems_[cur_pos] = i;
+            loc_[i] = cur_pos++;
+        }
+        mid_ = first_;
     }
-}
 
-// get the position of state in set queue for hashing
-int GetPosByState(const SetQueue &queue,
-        const DFAStatePtr &state, int size) {
-    if (state) {
-        for (int i = 0; i < size; ++i) {
-            const auto &cur_set = queue[i];
-            if (cur_set.find(state) != cur_set.end()) {
-                return i;
-            }
-        }
+    void Mark(StateIndex state) {
+        auto block = block_of_[state];
+        auto pos = loc_[state];
+        auto &mid = mid_[block];
+        if (pos < mid) return;
+        if (mid == first_[block]) touched_.push_back(block);
+        // swap current state to the end of marked part
+        auto other = elems_[mid];
+        elems_[pos] = other;
+        loc_[other] = pos;
+        elems_[mid] = state;
+        loc_[state] = mid++;
     }
-    return -1;
-}
 
-// part of DFA simplify algorithm
-void GetDivision(SetQueue &set_queue, const rex::re::SymbolSet &symbols) {
-    // store the size of queue for comparison
-    int queue_size;
-    // get the divisions of current DFA states
-    do {
-        queue_size = set_queue.size();
-        for (int i = 0; i < queue_size; ++i) {
-            const auto &front = set_queue.front();
-            if (front.size() <= 1) {
-                // cannot be split
-                set_queue.push_back(front);
-                set_queue.pop_front();
-                continue;
-            }
-            // to store new divisions of state set
-            DFAHashMap hash_map;
-            for (const auto &state : front) {
-                PosHash hash_val = 0;
-                for (const auto &symbol : symbols) {
-                    // for each symbols in symbol set
-                    DFAStatePtr next = nullptr;
-                    // find next state
-                    for (const auto &edge : state->out_edges()) {
-                        if (edge->symbol()->Equal(symbol.get())) {
-                            next = edge->next_state();
-                            break;
-                        }
-                    }
-                    // get the position of set that includes next state
-                    rex::re::HashCombile(hash_val, GetPosByState(set_queue,
-                            next, queue_size - i));
-                }
-                // insert into hash map
-                InsertIntoMap(hash_map, hash_val, state);
+    // split all blocks that have been marked partially,
+    // the smaller part of each block will become a new block
+    template <typename Handler>
+    void Split(Handler NewBlock) {
+        for (const auto &block : touched_) {
+            auto first = first_[block], mid = mid_[block];
+            auto end = end_[block];
+            mid_[block] = first;
+            if (mid == end) continue;
+            // get the range of new block
+            auto new_block = first_.size();
+            if (mid - first <= end - mid) {
+                first_[block] = mid;
+                mid_[block] = mid;
+                first_.push_back(first);
+                end_.push_back(mid);
             }
-            // push into queue
-            for (const auto &it : hash_map) {
-                set_queue.push_back(it.second);
+            else {
+                end_[block] = mid;
+                first_.push_back(mid);
+                end_.push_back(end);
             }
-            set_queue.pop_front();
-        }
-    } while (set_queue.size() != queue_size);
-}
-
-// get the state map for mapping old states to new states
-StateMap GetStateMap(const SetQueue &set_queue, const DFAStateSet &finals,
-        const DFAStatePtr &initial, DFAStatePtr &init_ptr,
-        DFAStateSet &states, DFAStateSet &final_states) {
-    StateMap state_map;
-    for (const auto &state_set : set_queue) {
-        auto cur_state = std::make_shared<rex::re::DFAState>();
-        if (!init_ptr && state_set.find(initial) != state_set.end()) {
-            init_ptr = cur_state;
-        }
-        bool added = false;
-        for (const auto &state : state_set) {
-            if (!added) {
-                if (finals.find(state) != finals.end()) {
-                    final_states.insert(cur_state);
-                }
-                else {
-                    states.insert(cur_state);
-                }
-                added = true;
+            mid_.push_back(first_.back());
+            for (auto i = first_.back(); i < end_.back(); ++i) {
+                block_of_[elems_[i]] = new_block;
             }
-            state_map[state] = cur_state;
+            NewBlock(new_block);
         }
+        touched_.clear();
     }
-    return std::move(state_map);
-}
 
-// create edge & insert edge into edge map
-inline void InsertEdge(EdgeMap &edge_map, const rex::re::SymbolPtr &symbol,
-        const DFAStatePtr &next_state) {
-    auto new_edge = std::make_shared<rex::re::DFAEdge>(symbol, next_state);
-    edge_map.insert({symbol, new_edge});
-}
-
-// part of DFA simplify algorithm
-void RebuildDFAState(const SetQueue &set_queue,
-        const rex::re::SymbolSet &symbols, StateMap &state_map) {
-    for (const auto &state_set : set_queue) {
-        // to store edges of current state
-        EdgeMap edge_map;
-        DFAStatePtr cur_state = nullptr;
-        // add edges for current state
-        for (const auto &state : state_set) {
-            // set current state
-            if (!cur_state) cur_state = state_map[state];
-            // the edge map is full
-            if (edge_map.size() == symbols.size()) break;
-            // for each symbols
-            for (const auto &symbol : symbols) {
-                // find next state
-                DFAStatePtr next = nullptr;
-                for (const auto &edge : state->out_edges()) {
-                    if (edge->symbol() == symbol) {
-                        next = edge->next_state();
-                        break;
-                    }
-                }
-                // insert edge into edge map
-                if (!next) {
-                    edge_map.insert({symbol, nullptr});
-                }
-                else if (next == state) {
-                    InsertEdge(edge_map, symbol, state_map[next]);
-                }
-                else {
-                    const auto &next_state = state_map[next];
-                    if (state_map[state] != next_state) {
-                        InsertEdge(edge_map, symbol, next_state);
-                    }
-                }
-            }
-        }
-        // insert edges to current state
-        for (const auto &it : edge_map) {
-            if (it.second) cur_state->AddEdge(it.second);
-        }
+    const StateIndex *begin(std::size_t block) const {
+        return elems_.data() + first_[block];
     }
-}
+    const StateIndex *end(std::size_t block) const {
+        return elems_.data() + end_[block];
+    }
+    std::size_t block_size(std::size_t block) const {
+        return end_[block] - first_[block];
+    }
+    std::size_t block_of(StateIndex state) const {
+        return block_of_[state];
+    }
+    std::size_t block_count() const { return first_.size(); }
+
+private:
+    std::vector<StateIndex> elems_, loc_;
+    std::vector<std::size_t> block_of_, first_, end_, mid_, touched_;
+};
 
 } // namespace
 
@@ -177,8 +124,9 @@ bool DFAModel::TestString(const std::string &str) {
     auto state = initial_;
     for (const auto &c : str) {
         bool switch_flag = false;
+        auto cls = char_class_.GetClass(c);
         for (const auto &edge : state->out_edges()) {
-            if (edge->symbol()->TestChar(c)) {
+            if (edge->char_class() == cls) {
                 state = edge->next_state();
                 switch_flag = true;
                 break;
@@ -189,31 +137,166 @@ bool DFAModel::TestString(const std::string &str) {
     return final_states_.find(state) != final_states_.end();
 }
 
-// a rough implementation of Hopcroft's algorithm
-// TODO: optimize sub-functions
+// Hopcroft's algorithm, runs in O(kn log n) time
 void DFAModel::Simplify() {
-    // initial the queue of state sets
-    SetQueue set_queue;
-    set_queue.push_back(states_);
-    set_queue.push_back(final_states_);
-    // get the divisions of simplified DFA states
-    GetDivision(set_queue, symbols_);
-    // rebuild the simplified states of DFA
-    DFAStatePtr initial_state = nullptr;
-    DFAStateSet states, final_states;
-    // get the state map for mapping old states to new states
-    auto state_map = GetStateMap(set_queue, final_states_, initial_,
-            initial_state, states, final_states);
-    RebuildDFAState(set_queue, symbols_, state_map);
-    // replace states of current model
+    // assign index for all states
+    std::vector<DFAStatePtr> states;
+    std::unordered_map<DFAStatePtr, StateIndex> id_map;
+    auto AddIndex = [&states, &id_map](const DFAStatePtr &state) {
+        if (id_map.insert({state, states.size()}).second) {
+            states.push_back(state);
+        }
+    };
+    AddIndex(initial_);
+    for (const auto &state : order_) AddIndex(state);
+    // make DFA complete by adding the dead state
+    StateIndex dead = states.size();
+    std::size_t state_count = states.size() + 1;
+    auto class_count = char_class_.class_count();
+    // get transitions & symbols of all char classes
+    std::vector<StateIndex> next(state_count * class_count, dead);
+    std::vector<SymbolPtr> class_symbols(class_count);
+    for (StateIndex i = 0; i < dead; ++i) {
+        for (const auto &edge : states[i]->out_edges()) {
+            auto cls = edge->char_class();
+            next[i * class_count + cls] = id_map[edge->next_state()];
+            class_symbols[cls] = edge->symbol();
+        }
+    }
+    // get inverse transitions, stored as adjacency list
+    std::vector<std::size_t> inv_offsets(state_count * class_count + 1, 0);
+    std::vector<StateIndex> inv_states(next.size());
+    // NOTE:  inverse lists are indexed by 'target * class_count + class'
+    for (StateIndex i = 0; i < state_count; ++i) {
+        for (std::size_t cls = 0; cls < class_count; ++cls) {
+            ++inv_offsets[next[i * class_count + cls] * class_count + cls];
+        }
+    }
+    std::size_t sum = 0;
+    for (auto &&i : inv_offsets) {
+        auto count = i;
+        i = sum;
+        sum += count;
+    }
+    auto inv_pos = inv_offsets;
+    for (StateIndex i = 0; i < state_count; ++i) {
+        for (std::size_t cls = 0; cls < class_count; ++cls) {
+            auto index = next[i * class_count + cls] * class_count + cls;
+            inv_states[inv_pos[index]++] = i;
+        }
+    }
+    // initialize partition, separate final states from the others,
+    // and final states with different tokens can not be merged
+    std::vector<std::size_t> labels(state_count, 0);
+    for (const auto &state : final_states_) {
+        labels[id_map[state]] = state->token() + 1;
+    }
+    Partition partition(labels);
+    // add all blocks except the largest one to worklist
+    std::vector<std::size_t> worklist;
+    std::size_t largest = 0;
+    for (std::size_t i = 1; i < partition.block_count(); ++i) {
+        if (partition.block_size(i) > partition.block_size(largest)) {
+            largest = i;
+        }
+    }
+    for (std::size_t i = 0; i < partition.block_count(); ++i) {
+        if (i != largest) worklist.push_back(i);
+    }
+    // refine partition until there are no splitters
+    auto AddBlock = [&worklist](std::size_t block) {
+        worklist.push_back(block);
+    };
+    std::vector<StateIndex> splitter;
+    while (!worklist.empty()) {
+        auto block = worklist.back();
+        worklist.pop_back();
+        splitter.assign(partition.begin(block), partition.end(block));
+        for (std::size_t cls = 0; cls < class_count; ++cls) {
+            // mark all predecessors of splitter
+            for (const auto &state : splitter) {
+                auto index = state * class_count + cls;
+                for (auto i = inv_offsets[index];
+                        i < inv_offsets[index + 1]; ++i) {
+                    partition.Mark(inv_states[i]);
+                }
+            }
+            partition.Split(AddBlock);
+        }
+    }
+    // create new states for all blocks, except the block of dead state
+    // which contains all states that can not reach any final states
+    auto dead_block = partition.block_of(dead);
+    std::vector<DFAStatePtr> new_states(partition.block_count());
+    std::vector<StateIndex> block_reps(partition.block_count());
+    auto initial_block = partition.block_of(0);
     Release(false);
-    initial_ = initial_state;
-    states_ = states;
-    final_states_ = final_states;
+    for (StateIndex i = 0; i < dead; ++i) {
+        auto block = partition.block_of(i);
+        if (block == dead_block || new_states[block]) continue;
+        auto &state = new_states[block];
+        state = std::make_shared<DFAState>();
+        block_reps[block] = i;
+        if (labels[i]) {
+            state->set_token(labels[i] - 1);
+            AddFinalState(state);
+        }
+        else {
+            AddState(state);
+        }
+    }
+    // rebuild edges by the representative state of each block
+    for (std::size_t block = 0; block < new_states.size(); ++block) {
+        if (!new_states[block]) continue;
+        auto rep = block_reps[block];
+        for (std::size_t cls = 0; cls < class_count; ++cls) {
+            auto next_block = partition.block_of(next[rep * class_count + cls]);
+            if (next_block == dead_block) continue;
+            auto new_edge = std::make_shared<DFAEdge>(class_symbols[cls],
+                    cls, new_states[next_block]);
+            new_states[block]->AddEdge(new_edge);
+        }
+    }
+    // set initial state, the language of DFA may be empty
+    if (initial_block == dead_block) {
+        initial_ = std::make_shared<DFAState>();
+        AddState(initial_);
+    }
+    else {
+        initial_ = new_states[initial_block];
+    }
 }
 
-void DFAModel::GenerateStateTable() {
-    // TODO
+StateTablePtr DFAModel::GenerateStateTable() const {
+    // assign index for all states (0 for dead state, 1 for initial state)
+    std::vector<DFAStatePtr> states = {nullptr};
+    std::unordered_map<DFAStatePtr, std::size_t> id_map;
+    auto AddIndex = [&states, &id_map](const DFAStatePtr &state) {
+        if (id_map.insert({state, states.size()}).second) {
+            states.push_back(state);
+        }
+    };
+    AddIndex(initial_);
+    for (const auto &state : order_) AddIndex(state);
+    // every char class occupies a column of table
+    auto class_count = char_class_.class_count();
+    auto table = std::make_shared<StateTable>(states.size(), class_count);
+    for (int c = 0; c < 256; ++c) {
+        auto ch = static_cast<char>(c);
+        table->SetCharClass(ch, char_class_.GetClass(ch));
+    }
+    // fill the transitions & accept bitmap
+    for (std::size_t i = 1; i < states.size(); ++i) {
+        for (const auto &edge : states[i]->out_edges()) {
+            auto next = id_map.at(edge->next_state());
+            table->SetTransition(i, edge->char_class(), next);
+        }
+        if (final_states_.find(states[i]) != final_states_.end()) {
+            table->SetAccept(i, states[i]->token());
+        }
+    }
+    table->set_initial(id_map.at(initial_));
+    return table;
 }
 
 #if NDEBUG
@@ -245,7 +328,7 @@ void DFAModel::Debug() {
         for (const auto &s : set) {
             cout << "state " << GetStateId(s) << ' ';
             if (s == initial_) cout << "(initial) ";
-            if (fin) cout << "(final) ";
+            if (fin) cout << "(final, token " << s->token() << ") ";
             cout << ':' << endl;
             for (const auto &e : s->out_edges()) {
                 cout << "  edge to state " << GetStateId(e->next_state());
@@ -4,10 +4,13 @@
 #include <memory>
 #include <utility>
 #include <list>
+#include <vector>
 #include <unordered_set>
 #include <string>
 
 #include <re/util/charset.h>
+#include <re/util/charclass.h>
+#include <re/util/table.h>
 
 namespace rex::re {
 
@@ -21,48 +24,60 @@ using DFAModelPtr = std::shared_ptr<DFAModel>;
 
 class DFAEdge {
 public:
-    DFAEdge(const SymbolPtr &symbol, const DFAStatePtr &next)
-            : symbol_(symbol), next_state_(next) {}
+    DFAEdge(const SymbolPtr &symbol, std::size_t char_class,
+            const DFAStatePtr &next)
+            : symbol_(symbol), char_class_(char_class), next_state_(next) {}
     ~DFAEdge() {}
 
     const SymbolPtr &symbol() const { return symbol_; }
+    std::size_t char_class() const { return char_class_; }
     const DFAStatePtr &next_state() const { return next_state_; }
 
 private:
     SymbolPtr symbol_;
+    std::size_t char_class_;
     DFAStatePtr next_state_;
 };
 
 class DFAState {
 public:
-    DFAState() {}
+    DFAState() : token_(0) {}
     ~DFAState() {}
 
     void AddEdge(const DFAEdgePtr &edge) { out_edges_.push_back(edge); }
     void Release() { out_edges_.clear(); }
 
-    const std::list<DFAEdgePtr> out_edges() const { return out_edges_; }
+    // token of final state, smaller token has higher priority
+    void set_token(int token) { token_ = token; }
+
+    const std::list<DFAEdgePtr> &out_edges() const { return out_edges_; }
+    int token() const { return token_; }
 
 private:
     std::list<DFAEdgePtr> out_edges_;
+    int token_;
 };
 
+// NOTE:  states are numbered by the order they were added, so that
+//        state tables of the same pattern are always the same
 class DFAModel {
 public:
     DFAModel() {}
     ~DFAModel() { Release(); }
 
-    void AddState(const DFAStatePtr &state) { states_.insert(state); }
+    void AddState(const DFAStatePtr &state) {
+        if (states_.insert(state).second) order_.push_back(state);
+    }
 
     void AddFinalState(const DFAStatePtr &state) {
-        final_states_.insert(state);
+        if (final_states_.insert(state).second) order_.push_back(state);
     }
 
     void AddSymbol(const SymbolPtr &symbol) { symbols_.insert(symbol); }
 
     void Simplify();
     bool TestString(const std::string &str);
-    void GenerateStateTable();
+    StateTablePtr GenerateStateTable() const;
 
 #if NDEBUG
 #else
@@ -70,6 +85,20 @@ public:
 #endif
 
     void set_initial(const DFAStatePtr &state) { initial_ = state; }
+    void set_char_class(const CharClassMap &char_class) {
+        char_class_ = char_class;
+    }
+
+    const CharClassMap &char_class() const { return char_class_; }
+    std::size_t state_count() const {
+        return states_.size() + final_states_.size();
+    }
+    std::size_t edge_count() const {
+        std::size_t count = 0;
+        for (const auto &i : states_) count += i->out_edges().size();
+        for (const auto &i : final_states_) count += i->out_edges().size();
+        return count;
+    }
 
 private:
     using DFAStateSet = std::unordered_set<DFAStatePtr>;
@@ -80,12 +109,16 @@ private:
         for (auto &&i : final_states_) i->Release();
         states_.clear();
         final_states_.clear();
+        order_.clear();
         if (with_symbols) symbols_.clear();
     }
 
     DFAStatePtr initial_;
     DFAStateSet states_, final_states_;
+    // all states in the order they were added
+    std::vector<DFAStatePtr> order_;
     SymbolSet symbols_;
+    CharClassMap char_class_;
 };
 
 } // namespace rex::re
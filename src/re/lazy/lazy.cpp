@@ -0,0 +1,103 @@
+#include <re/lazy/lazy.h>
+
+#include <utility>
+
+namespace {
+
+// estimated memory overhead of each cached state
+// (hash map node, header of node list, state pointer & accept flag)
+constexpr std::size_t kStateOverhead = 64;
+
+const rex::re::NFAModel &GetNormalizedNFA(const rex::re::NFAModelPtr &nfa) {
+    nfa->NormalizeNFA();
+    return *nfa;
+}
+
+} // namespace
+
+namespace rex::re {
+
+LazyDFA::LazyDFA(const NFAModelPtr &nfa, std::size_t mem_budget)
+        : nfa_(nfa), alphabet_(GetNormalizedNFA(nfa)), closures_(*nfa),
+          class_count_(alphabet_.class_count()),
+          mem_budget_(mem_budget), mem_usage_(0), flush_count_(0),
+          fallback_count_(0) {
+    start_nodes_ = closures_.GetClosure(nfa_->start());
+    start_ = AddState(NodeList(start_nodes_));
+}
+
+LazyDFA::StateId LazyDFA::AddState(NodeList &&nodes) {
+    auto it = state_map_.find(nodes);
+    if (it != state_map_.end()) return it->second;
+    // flush the cache if there is no enough space
+    auto size = kStateOverhead + nodes.size() * sizeof(NFAIndex) +
+            class_count_ * sizeof(StateId);
+    if (mem_usage_ + size > mem_budget_ && !state_nodes_.empty()) {
+        Flush();
+        it = state_map_.find(nodes);
+        if (it != state_map_.end()) return it->second;
+    }
+    // add new state
+    StateId id = state_nodes_.size();
+    auto ret = state_map_.insert({std::move(nodes), id});
+    const auto &node_list = ret.first->first;
+    state_nodes_.push_back(&node_list);
+    next_.resize(next_.size() + class_count_, kUnknown);
+    accept_.push_back(nfa_->GetToken(node_list) >= 0);
+    mem_usage_ += size;
+    return id;
+}
+
+LazyDFA::StateId LazyDFA::GetNextState(StateId state, std::size_t cls) {
+    alphabet_.GetMove(*nfa_, *state_nodes_[state], cls, move_);
+    auto next = kDead;
+    auto flush_count = flush_count_;
+    if (!move_.empty()) next = AddState(closures_.GetClosure(move_));
+    // the transition can not be cached if current state has been flushed
+    if (flush_count == flush_count_) {
+        next_[state * class_count_ + cls] = next;
+    }
+    return next;
+}
+
+void LazyDFA::Flush() {
+    state_map_.clear();
+    state_nodes_.clear();
+    next_.clear();
+    accept_.clear();
+    mem_usage_ = 0;
+    ++flush_count_;
+    start_ = AddState(NodeList(start_nodes_));
+}
+
+bool LazyDFA::TestString(const char *str, std::size_t len) {
+    const auto &char_class = alphabet_.char_class();
+    auto state = start_;
+    // position of the last flush
+    std::size_t flush_pos = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        auto cls = char_class.GetClass(str[i]);
+        auto next = next_[state * class_count_ + cls];
+        if (next == kUnknown) {
+            auto state_count = state_nodes_.size();
+            auto flush_count = flush_count_;
+            next = GetNextState(state, cls);
+            if (flush_count != flush_count_) {
+                // check if the cache is thrashing
+                if (i - flush_pos < state_count * kMinBytesPerState &&
+                        next != kDead) {
+                    if (!vm_) vm_ = std::make_shared<PikeVM>(nfa_);
+                    ++fallback_count_;
+                    return vm_->TestString(*state_nodes_[next],
+                                           str + i + 1, len - i - 1);
+                }
+                flush_pos = i;
+            }
+        }
+        if (next == kDead) return false;
+        state = next;
+    }
+    return accept_[state];
+}
+
+} // namespace rex::re
@@ -0,0 +1,81 @@
+#ifndef REX_RE_LAZY_LAZY_H_
+#define REX_RE_LAZY_LAZY_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/nfa/nfa.h>
+#include <re/nfa/subset.h>
+#include <re/vm/vm.h>
+
+namespace rex::re {
+
+class LazyDFA;
+
+using LazyDFAPtr = std::shared_ptr<LazyDFA>;
+
+// DFA that builds its states from NFA on demand while matching
+// NOTE:  states & transitions are cached within a fixed memory budget,
+//        and the whole cache will be flushed when it is full,
+//        matching will modify the cache, so it's not thread-safe
+// NOTE:  if the cache is flushed too often (less than
+//        'kMinBytesPerState' bytes scanned per cached state),
+//        the rest of string will be matched by Pike VM,
+//        since building states costs more than simulating NFA
+class LazyDFA {
+public:
+    static constexpr std::size_t kDefaultBudget = 1 << 20;
+    static constexpr std::size_t kMinBytesPerState = 10;
+
+    LazyDFA(const NFAModelPtr &nfa, std::size_t mem_budget = kDefaultBudget);
+    ~LazyDFA() {}
+
+    bool TestString(const char *str, std::size_t len);
+    bool TestString(const std::string &str) {
+        return TestString(str.data(), str.size());
+    }
+
+    // count of cached states
+    std::size_t state_count() const { return state_nodes_.size(); }
+    // times that the cache has been flushed
+    std::size_t flush_count() const { return flush_count_; }
+    // times that matching has fallen back to Pike VM
+    std::size_t fallback_count() const { return fallback_count_; }
+    // estimated size of cache in bytes
+    std::size_t mem_usage() const { return mem_usage_; }
+    std::size_t mem_budget() const { return mem_budget_; }
+
+private:
+    using StateId = std::int32_t;
+
+    // transition that has not been computed yet
+    static constexpr StateId kUnknown = -1;
+    // transition to dead state
+    static constexpr StateId kDead = -2;
+
+    StateId AddState(NodeList &&nodes);
+    StateId GetNextState(StateId state, std::size_t cls);
+    void Flush();
+
+    NFAModelPtr nfa_;
+    NFAAlphabet alphabet_;
+    ClosureCache closures_;
+    std::size_t class_count_;
+    NodeList start_nodes_, move_;
+    std::unordered_map<NodeList, StateId, NodeListHash> state_map_;
+    std::vector<const NodeList *> state_nodes_;
+    std::vector<StateId> next_;
+    std::vector<bool> accept_;
+    StateId start_;
+    std::size_t mem_budget_, mem_usage_, flush_count_, fallback_count_;
+    // used when cache is thrashing, created on demand
+    PikeVMPtr vm_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_LAZY_LAZY_H_
@@ -0,0 +1,83 @@
+#include <re/lexer/lexer.h>
+
+#include <cassert>
+
+namespace rex::re {
+
+DFAModelPtr Lexer::GenerateDFA(CompileStats *stats) const {
+    // connect all rules to the same entry node
+    NFAModel nfa;
+    {
+        PhaseTimer timer(stats, &CompileStats::nfa_time);
+        auto node = nfa.AddNode();
+        auto entry = nfa.AddEdge(kNFANone, node);
+        for (std::size_t i = 0; i < rules_.size(); ++i) {
+            auto fragment = rules_[i]->GenerateNFA(nfa);
+            nfa.ConnectEdge(node, fragment.entry);
+            nfa.AddFinalNode(fragment.tail, i);
+        }
+        nfa.set_entry(entry);
+        nfa.set_tail(node);
+    }
+    RecordNFA(stats, nfa);
+    {
+        PhaseTimer timer(stats, &CompileStats::normalize_time);
+        nfa.NormalizeNFA();
+    }
+    // generate & minimize DFA
+    DFAModelPtr dfa;
+    {
+        PhaseTimer timer(stats, &CompileStats::dfa_time);
+        dfa = pool_ ? nfa.GenerateDFA(0, *pool_) : nfa.GenerateDFA();
+    }
+    RecordDFA(stats, *dfa, false);
+    {
+        PhaseTimer timer(stats, &CompileStats::simplify_time);
+        dfa->Simplify();
+    }
+    RecordDFA(stats, *dfa, true);
+    return dfa;
+}
+
+void Lexer::Build(CompileStats *stats) {
+    auto dfa = GenerateDFA(stats);
+    {
+        PhaseTimer timer(stats, &CompileStats::build_time);
+        table_ = dfa->GenerateStateTable();
+    }
+    RecordTable(stats, *table_);
+}
+
+Token Lexer::ReadToken(const char *str, std::size_t len) const {
+    assert(table_);
+    auto state = table_->initial();
+    int rule = -1;
+    std::size_t last = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        state = table_->Next(state, str[i]);
+        if (table_->IsDead(state)) break;
+        // record the last final state
+        auto token = table_->GetToken(state);
+        if (token >= 0) {
+            rule = token;
+            last = i + 1;
+        }
+    }
+    if (rule < 0) return {kErrorToken, 0, len ? 1U : 0U};
+    return {tokens_[rule], 0, last};
+}
+
+std::vector<Token> Lexer::Tokenize(const char *str,
+        std::size_t len) const {
+    std::vector<Token> tokens;
+    std::size_t pos = 0;
+    while (pos < len) {
+        auto token = ReadToken(str + pos, len - pos);
+        token.pos = pos;
+        pos += token.len;
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+} // namespace rex::re
@@ -0,0 +1,82 @@
+#ifndef REX_RE_LEXER_LEXER_H_
+#define REX_RE_LEXER_LEXER_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include <re/reobj/reobj.h>
+#include <re/dfa/dfa.h>
+#include <re/util/table.h>
+#include <re/stats/stats.h>
+#include <re/util/pool.h>
+
+namespace rex::re {
+
+class Lexer;
+
+using LexerPtr = std::shared_ptr<Lexer>;
+
+struct Token {
+    // token id of rule, or 'kErrorToken' if no rule matches
+    int id;
+    // position & length of token in input
+    std::size_t pos, len;
+};
+
+// lexer that combines all rules into a single DFA
+// NOTE:  tokens are matched by the rule of maximal munch, if there are
+//        multiple longest matches, the rule added first will be picked
+class Lexer {
+public:
+    // token id of unrecognized char
+    static constexpr int kErrorToken = -1;
+
+    Lexer() {}
+    // lexer with a prebuilt state table (e.g. loaded from file),
+    // rules can not be added to it
+    Lexer(const StateTablePtr &table, const std::vector<int> &tokens)
+            : tokens_(tokens), table_(table) {}
+    ~Lexer() {}
+
+    // add a new rule, rules added earlier have higher priority
+    void AddRule(const REObject &reo, int token) {
+        rules_.push_back(reo);
+        tokens_.push_back(token);
+        table_.reset();
+    }
+
+    // generate the combined DFA of all rules,
+    // final states of DFA carry the index of rules as tokens,
+    // statistics of compilation will be stored to 'stats' if not null
+    DFAModelPtr GenerateDFA(CompileStats *stats = nullptr) const;
+    // build the state table of lexer, must be called before matching
+    void Build(CompileStats *stats = nullptr);
+
+    // read the longest token from the beginning of input
+    // returns a token with length 1 & 'kErrorToken' if no rule matches
+    Token ReadToken(const char *str, std::size_t len) const;
+    // split the whole input into tokens
+    std::vector<Token> Tokenize(const char *str, std::size_t len) const;
+    std::vector<Token> Tokenize(const std::string &str) const {
+        return Tokenize(str.data(), str.size());
+    }
+
+    // generate DFA by the threads of 'pool' if it is not null
+    void set_pool(const ThreadPoolPtr &pool) { pool_ = pool; }
+
+    const StateTablePtr &table() const { return table_; }
+    const std::vector<int> &tokens() const { return tokens_; }
+    const ThreadPoolPtr &pool() const { return pool_; }
+
+private:
+    std::vector<REObject> rules_;
+    std::vector<int> tokens_;
+    StateTablePtr table_;
+    ThreadPoolPtr pool_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_LEXER_LEXER_H_
@@ -0,0 +1,269 @@
+#include <re/multi/multi.h>
+
+#include <utility>
+#include <algorithm>
+#include <cstring>
+
+#include <re/util/cpu.h>
+
+namespace {
+
+constexpr auto npos = std::string_view::npos;
+
+} // namespace
+
+namespace rex::re {
+
+AhoCorasick::AhoCorasick(const std::vector<std::string> &literals)
+        : max_len_(0), dense_(false) {
+    // each byte that used by literals forms a char class
+    CharSet used;
+    for (const auto &lit : literals) {
+        for (const auto &c : lit) used.Insert(c);
+    }
+    for (int c = 0; c < 256; ++c) {
+        if (!used.Include(c)) continue;
+        CharSet char_set;
+        char_set.Insert(c);
+        char_class_.Split(char_set);
+    }
+    char_class_.Normalize();
+    class_count_ = char_class_.class_count();
+    // build trie
+    std::vector<std::vector<std::pair<std::uint8_t, StateId>>> children(1);
+    match_len_.assign(1, 0);
+    for (const auto &lit : literals) {
+        StateId state = 0;
+        for (const auto &c : lit) {
+            auto cls = char_class_.GetClass(c);
+            auto &edges = children[state];
+            auto it = std::find_if(edges.begin(), edges.end(),
+                    [cls](const auto &edge) { return edge.first == cls; });
+            if (it != edges.end()) {
+                state = it->second;
+                continue;
+            }
+            StateId next = children.size();
+            edges.push_back({cls, next});
+            children.emplace_back();
+            match_len_.push_back(0);
+            state = next;
+        }
+        match_len_[state] = lit.size();
+        max_len_ = std::max(max_len_, lit.size());
+    }
+    // flatten edges into compressed layout
+    auto state_count = children.size();
+    edge_offsets_.reserve(state_count + 1);
+    for (auto &&edges : children) {
+        std::sort(edges.begin(), edges.end());
+        edge_offsets_.push_back(edge_classes_.size());
+        for (const auto &edge : edges) {
+            edge_classes_.push_back(edge.first);
+            edge_targets_.push_back(edge.second);
+        }
+    }
+    edge_offsets_.push_back(edge_classes_.size());
+    // get failure links by breadth-first search
+    fail_.assign(state_count, 0);
+    std::vector<StateId> order = {0};
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        auto state = order[i];
+        for (const auto &edge : children[state]) {
+            auto child = edge.second;
+            if (state) fail_[child] = Next(fail_[state], edge.first);
+            // literals that are suffixes of failure state also match
+            match_len_[child] = std::max(match_len_[child],
+                                         match_len_[fail_[child]]);
+            order.push_back(child);
+        }
+    }
+    // resolve all transitions if dense table is small enough
+    dense_ = state_count * class_count_ <= kMaxDenseEntries;
+    if (dense_) {
+        next_.resize(state_count * class_count_);
+        for (const auto &state : order) {
+            auto row = next_.data() + state * class_count_;
+            for (std::size_t cls = 0; cls < class_count_; ++cls) {
+                row[cls] = state ? next_[fail_[state] * class_count_ + cls]
+                                 : 0;
+            }
+            for (const auto &edge : children[state]) {
+                row[edge.first] = edge.second;
+            }
+        }
+        decltype(edge_offsets_)().swap(edge_offsets_);
+        decltype(edge_targets_)().swap(edge_targets_);
+        decltype(edge_classes_)().swap(edge_classes_);
+        decltype(fail_)().swap(fail_);
+    }
+}
+
+AhoCorasick::StateId AhoCorasick::Next(StateId state,
+        std::size_t cls) const {
+    if (dense_) return next_[state * class_count_ + cls];
+    // follow failure links until an edge is found
+    for (;;) {
+        auto begin = edge_classes_.begin() + edge_offsets_[state];
+        auto end = edge_classes_.begin() + edge_offsets_[state + 1];
+        auto it = std::lower_bound(begin, end, cls);
+        if (it != end && *it == cls) {
+            return edge_targets_[it - edge_classes_.begin()];
+        }
+        if (!state) return 0;
+        state = fail_[state];
+    }
+}
+
+bool AhoCorasick::Find(std::string_view text, std::size_t pos,
+        std::size_t &start, std::size_t &len) const {
+    auto best_start = npos, best_end = npos;
+    StateId state = 0;
+    for (auto i = pos; i < text.size(); ++i) {
+        state = Next(state, char_class_.GetClass(text[i]));
+        if (auto match_len = match_len_[state]) {
+            // earlier start, or the same start with a later end
+            auto cur_start = i + 1 - match_len;
+            if (cur_start <= best_start) {
+                best_start = cur_start;
+                best_end = i + 1;
+            }
+        }
+        // matches that end later can not start before the best one
+        if (best_start != npos && i + 1 >= best_start + max_len_) break;
+    }
+    if (best_start == npos) return false;
+    start = best_start;
+    len = best_end - best_start;
+    return true;
+}
+
+TeddyMatcher::TeddyMatcher(const std::vector<std::string> &literals)
+        : literals_(literals), mask_len_(kMaxMaskLen) {
+    std::memset(lo_masks_, 0, sizeof(lo_masks_));
+    std::memset(hi_masks_, 0, sizeof(hi_masks_));
+    // sort literals so that literals with common prefix
+    // can be put into the same bucket
+    std::sort(literals_.begin(), literals_.end());
+    for (const auto &lit : literals_) {
+        mask_len_ = std::min(mask_len_, lit.size());
+    }
+    for (std::size_t i = 0; i < literals_.size(); ++i) {
+        auto bucket = i * kBucketCount / literals_.size();
+        buckets_[bucket].push_back(i);
+        for (std::size_t k = 0; k < mask_len_; ++k) {
+            auto c = static_cast<std::uint8_t>(literals_[i][k]);
+            lo_masks_[k][c & 0xf] |= 1 << bucket;
+            hi_masks_[k][c >> 4] |= 1 << bucket;
+        }
+    }
+    for (auto &&bucket : buckets_) {
+        std::stable_sort(bucket.begin(), bucket.end(),
+                [this](std::size_t lhs, std::size_t rhs) {
+                    return literals_[lhs].size() > literals_[rhs].size();
+                });
+    }
+}
+
+std::uint8_t TeddyMatcher::GetBuckets(const char *str) const {
+    std::uint8_t buckets = 0xff;
+    for (std::size_t k = 0; k < mask_len_; ++k) {
+        auto c = static_cast<std::uint8_t>(str[k]);
+        buckets &= lo_masks_[k][c & 0xf] & hi_masks_[k][c >> 4];
+    }
+    return buckets;
+}
+
+std::size_t TeddyMatcher::Verify(std::string_view text, std::size_t pos,
+        std::uint8_t buckets) const {
+    std::size_t len = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        if (!(buckets & (1 << i))) continue;
+        for (const auto &index : buckets_[i]) {
+            const auto &lit = literals_[index];
+            if (lit.size() <= len) break;
+            if (text.size() - pos >= lit.size() &&
+                    !std::memcmp(text.data() + pos, lit.data(), lit.size())) {
+                len = lit.size();
+                break;
+            }
+        }
+    }
+    return len;
+}
+
+bool TeddyMatcher::Find(std::string_view text, std::size_t pos,
+        std::size_t &start, std::size_t &len) const {
+#ifdef REX_RE_SSSE3
+    if (HasSSSE3()) return FindSSSE3(text, pos, start, len);
+#endif
+    return FindScalar(text, pos, start, len);
+}
+
+#ifdef REX_RE_SSSE3
+REX_RE_TARGET_SSSE3 bool TeddyMatcher::FindSSSE3(std::string_view text,
+        std::size_t pos, std::size_t &start, std::size_t &len) const {
+    auto str = text.data();
+    auto i = pos;
+    const auto nibble = _mm_set1_epi8(0x0f);
+    const auto zero = _mm_setzero_si128();
+    for (; i + 16 + mask_len_ - 1 <= text.size(); i += 16) {
+        auto result = _mm_set1_epi8(-1);
+        for (std::size_t k = 0; k < mask_len_; ++k) {
+            auto block = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(str + i + k));
+            auto lo = _mm_and_si128(block, nibble);
+            auto hi = _mm_and_si128(_mm_srli_epi16(block, 4), nibble);
+            auto lo_mask = _mm_load_si128(
+                    reinterpret_cast<const __m128i *>(lo_masks_[k]));
+            auto hi_mask = _mm_load_si128(
+                    reinterpret_cast<const __m128i *>(hi_masks_[k]));
+            result = _mm_and_si128(result,
+                    _mm_and_si128(_mm_shuffle_epi8(lo_mask, lo),
+                                  _mm_shuffle_epi8(hi_mask, hi)));
+        }
+        auto empty = _mm_movemask_epi8(_mm_cmpeq_epi8(result, zero));
+        auto candidates = ~static_cast<unsigned>(empty) & 0xffff;
+        if (!candidates) continue;
+        alignas(16) std::uint8_t buckets[16];
+        _mm_store_si128(reinterpret_cast<__m128i *>(buckets), result);
+        for (; candidates; candidates &= candidates - 1) {
+            auto offset = __builtin_ctz(candidates);
+            if (auto cur_len = Verify(text, i + offset, buckets[offset])) {
+                start = i + offset;
+                len = cur_len;
+                return true;
+            }
+        }
+    }
+    // handle the rest of text
+    return FindScalar(text, i, start, len);
+}
+#endif
+
+bool TeddyMatcher::FindScalar(std::string_view text, std::size_t pos,
+        std::size_t &start, std::size_t &len) const {
+    for (auto i = pos; i + mask_len_ <= text.size(); ++i) {
+        auto buckets = GetBuckets(text.data() + i);
+        if (!buckets) continue;
+        if (auto cur_len = Verify(text, i, buckets)) {
+            start = i;
+            len = cur_len;
+            return true;
+        }
+    }
+    return false;
+}
+
+MultiLiteral MakeMultiLiteral(const std::vector<std::string> &literals) {
+    auto lits = literals;
+    std::sort(lits.begin(), lits.end());
+    lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+    if (lits.empty() || lits.front().empty()) return nullptr;
+    if (HasSSSE3() && lits.size() <= TeddyMatcher::kMaxLiterals) {
+        return std::make_shared<TeddyMatcher>(lits);
+    }
+    return std::make_shared<AhoCorasick>(lits);
+}
+
+} // namespace rex::re
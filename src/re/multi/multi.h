@@ -0,0 +1,107 @@
+#ifndef REX_RE_MULTI_MULTI_H_
+#define REX_RE_MULTI_MULTI_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/util/charclass.h>
+
+namespace rex::re {
+
+class MultiLiteralInterface;
+
+using MultiLiteral = std::shared_ptr<MultiLiteralInterface>;
+
+// matcher of a set of non-empty literals
+class MultiLiteralInterface {
+public:
+    virtual ~MultiLiteralInterface() = default;
+    // find the leftmost-longest occurrence that starts at or after 'pos'
+    virtual bool Find(std::string_view text, std::size_t pos,
+            std::size_t &start, std::size_t &len) const = 0;
+};
+
+// Aho-Corasick automaton
+// NOTE:  transitions are stored in a dense table if it is small enough,
+//        otherwise only the edges of trie are stored (sorted by class),
+//        and failure links will be followed while matching
+class AhoCorasick : public MultiLiteralInterface {
+public:
+    // dense table will be used if it has no more entries
+    static constexpr std::size_t kMaxDenseEntries = 1 << 21;
+
+    AhoCorasick(const std::vector<std::string> &literals);
+
+    bool Find(std::string_view text, std::size_t pos,
+            std::size_t &start, std::size_t &len) const override;
+
+    bool dense() const { return dense_; }
+    std::size_t state_count() const { return match_len_.size(); }
+
+private:
+    using StateId = std::uint32_t;
+
+    StateId Next(StateId state, std::size_t cls) const;
+
+    CharClassMap char_class_;
+    std::size_t class_count_, max_len_;
+    bool dense_;
+    // dense transitions
+    std::vector<StateId> next_;
+    // edges of trie in compressed layout & failure links
+    std::vector<StateId> edge_offsets_, edge_targets_, fail_;
+    std::vector<std::uint8_t> edge_classes_;
+    // length of the longest literal that is a suffix of each state
+    std::vector<std::uint32_t> match_len_;
+};
+
+// 'Teddy' matcher, literals are put into 8 buckets, and the nibbles of
+// the first few bytes of each literal are packed into bucket masks
+// NOTE:  masks of 16 positions are looked up at once by SSSE3 'pshufb'
+//        if it is supported by CPU, positions that match the masks of a bucket
+//        are verified by comparing with all literals in the bucket
+class TeddyMatcher : public MultiLiteralInterface {
+public:
+    // literal sets with more literals should use Aho-Corasick
+    static constexpr std::size_t kMaxLiterals = 32;
+
+    TeddyMatcher(const std::vector<std::string> &literals);
+
+    bool Find(std::string_view text, std::size_t pos,
+            std::size_t &start, std::size_t &len) const override;
+
+private:
+    static constexpr std::size_t kBucketCount = 8;
+    static constexpr std::size_t kMaxMaskLen = 3;
+
+    // find by checking 16 positions at once, requires SSSE3
+    bool FindSSSE3(std::string_view text, std::size_t pos,
+            std::size_t &start, std::size_t &len) const;
+    // find by checking each position
+    bool FindScalar(std::string_view text, std::size_t pos,
+            std::size_t &start, std::size_t &len) const;
+    // get buckets that may match at 'str', by looking up masks
+    std::uint8_t GetBuckets(const char *str) const;
+    // get the length of the longest literal in buckets matched at 'pos'
+    std::size_t Verify(std::string_view text, std::size_t pos,
+            std::uint8_t buckets) const;
+
+    std::vector<std::string> literals_;
+    // literals of buckets, sorted by length in descending order
+    std::vector<std::size_t> buckets_[kBucketCount];
+    std::size_t mask_len_;
+    // bucket masks of low & high nibbles of each byte
+    alignas(16) std::uint8_t lo_masks_[kMaxMaskLen][16];
+    alignas(16) std::uint8_t hi_masks_[kMaxMaskLen][16];
+};
+
+// make a matcher for literals, returns null if any literal is empty
+MultiLiteral MakeMultiLiteral(const std::vector<std::string> &literals);
+
+} // namespace rex::re
+
+#endif // REX_RE_MULTI_MULTI_H_
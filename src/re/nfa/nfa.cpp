@@ -1,155 +1,277 @@
 #include <re/nfa/nfa.h>
-#include <re/util/util.h>
+#include <re/nfa/subset.h>
 
-#include <unordered_set>
-#include <queue>
+#include <deque>
 #include <unordered_map>
+#include <vector>
+#include <algorithm>
 
-namespace {
-
-using NFANodePtr = rex::re::NFANodePtr;
-using SymbolPtr = rex::re::SymbolPtr;
-
-class NFANodeSet : public std::unordered_set<NFANodePtr> {
-public:
-    using HashType = hasher::result_type;
-
-    NFANodeSet() : std::unordered_set<NFANodePtr>(), hash_value_(0) {}
-
-    void push(const NFANodePtr &ptr) {
-        auto ret = insert(ptr);
-        if (!ret.second) return;
-        auto new_hash = hash_function()(ptr);
-        rex::re::HashCombile(hash_value_, new_hash);
-    }
+namespace rex::re {
 
-    void merge(const NFANodeSet &node_set) {
-        // TODO: optimize?
-        for (const auto &i : node_set) insert(i);
-        rex::re::HashCombile(hash_value_, node_set.hash_value_);
+void NFAModel::NormalizeNFA() {
+    if (normalized_) return;
+    // add redundant epsilon edge for an entrance of NFA model
+    if (edges_[entry_].symbol != kNFANone) {
+        auto nil_node = AddNode();
+        auto nil_edge = AddEdge(kNFANone, nil_node);
+        ConnectEdge(nil_node, entry_);
+        entry_ = nil_edge;
     }
-
-    auto hash_value() const { return hash_value_; }
-
-private:
-    HashType hash_value_;
-};
-
-NFANodeSet GetEpsilonClosure(const NFANodePtr &node) {
-    NFANodeSet node_set;
-    std::queue<NFANodePtr> node_queue;
-    decltype(node_set.size()) last_size;
-    node_queue.push(node);
-    do {
-        last_size = node_set.size();
-        const auto &cur_node = node_queue.front();
-        for (const auto &edge : cur_node->out_edges()) {
-            if (!edge->symbol()) {
-                node_queue.push(edge->tail());
-            }
+    // flatten the out edges of all nodes into compact adjacency list
+    arc_offsets_.assign(nodes_.size() + 1, 0);
+    arcs_.clear();
+    arcs_.reserve(edges_.size());
+    arc_tags_.clear();
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        arc_offsets_[i] = arcs_.size();
+        for (auto e = nodes_[i].first_edge; e != kNFANone;
+                e = edges_[e].next) {
+            arcs_.push_back({edges_[e].symbol, edges_[e].tail});
+            if (has_tags()) arc_tags_.push_back(edge_tag(e));
         }
-        node_set.push(cur_node);
-        node_queue.pop();
-    } while (node_set.size() != last_size && !node_queue.empty());
-    return node_set;
+    }
+    arc_offsets_[nodes_.size()] = arcs_.size();
+    // get tokens of all final nodes, smaller token has higher priority
+    node_tokens_.assign(nodes_.size(), -1);
+    if (final_nodes_.empty()) {
+        node_tokens_[tail_] = 0;
+    }
+    for (const auto &it : final_nodes_) {
+        auto &token = node_tokens_[it.first];
+        if (token < 0 || it.second < token) token = it.second;
+    }
+    normalized_ = true;
 }
 
-// for DFA conversion
-// TODO: optimize
-NFANodeSet GetDFAState(const NFANodeSet &nodes, const SymbolPtr &symbol) {
-    NFANodeSet node_set, final_set;
-    for (const auto &node : nodes) {
-        for (const auto &edge : node->out_edges()) {
-            if (symbol->Equal(edge->symbol().get())) {
-                node_set.push(edge->tail());
-            }
-        }
+NFAFragment NFAModel::CopyFragment(const NFAFragment &fragment,
+        NFAIndex node_begin, NFAIndex node_end,
+        NFAIndex edge_begin, NFAIndex edge_end) {
+    NFAIndex node_offset = nodes_.size() - node_begin;
+    NFAIndex edge_offset = edges_.size() - edge_begin;
+    normalized_ = false;
+    auto MapEdge = [edge_offset](NFAIndex edge) {
+        return edge == kNFANone ? kNFANone : edge + edge_offset;
+    };
+    // copy nodes & edges, with all indices remapped
+    nodes_.reserve(nodes_.size() + node_end - node_begin);
+    edges_.reserve(edges_.size() + edge_end - edge_begin);
+    for (auto i = node_begin; i < node_end; ++i) {
+        const auto &node = nodes_[i];
+        nodes_.push_back({MapEdge(node.first_edge), MapEdge(node.last_edge)});
     }
-    for (const auto &node : node_set) {
-        auto ret = GetEpsilonClosure(node);
-        final_set.merge(ret);
+    for (auto i = edge_begin; i < edge_end; ++i) {
+        const auto &edge = edges_[i];
+        assert(edge.tail >= node_begin && edge.tail < node_end);
+        edges_.push_back({edge.symbol, edge.tail + node_offset,
+                          MapEdge(edge.next)});
+        auto tag = edge_tag(i);
+        if (tag != kNFANone) edge_tags_[i + edge_offset] = tag;
     }
-    return final_set;
+    return {fragment.entry + edge_offset, fragment.tail + node_offset};
 }
 
-} // namespace
-
-namespace rex::re {
+void NFAModel::MakeUnanchored() {
+    CharSet any;
+    any.Reverse();
+    // add a node with a self loop that accepts any chars
+    auto node = AddNode();
+    auto loop = AddEdge(AddSymbol(any.MakeSymbol()), node);
+    ConnectEdge(node, loop);
+    ConnectEdge(node, entry_);
+    entry_ = AddEdge(kNFANone, node);
+}
 
-void NFAModel::NormalizeNFA() {
-    // add redundant epsilon edge for an entrance of NFA model
-    if (entry_->symbol()) {
-        auto nil_node = std::make_shared<NFANode>();
-        auto nil_edge = std::make_shared<NFAEdge>(nullptr, nil_node);
-        nil_node->AddEdge(entry_);
-        entry_ = nil_edge;
+NFAModelPtr NFAModel::GenerateReverse() const {
+    auto model = std::make_shared<NFAModel>();
+    for (std::size_t i = 0; i < nodes_.size(); ++i) model->AddNode();
+    // reverse all edges
+    for (NFAIndex node = 0; node < nodes_.size(); ++node) {
+        for (auto arc = arc_begin(node); arc != arc_end(node); ++arc) {
+            auto symbol = model->AddSymbol(this->symbol(arc->symbol));
+            auto edge = model->AddEdge(symbol, node);
+            model->ConnectEdge(arc->tail, edge);
+        }
     }
-    // remove all unique symbol
-    for (auto it = symbol_set_.begin(); it != symbol_set_.end(); ) {
-        if ((*it).use_count() == 1) {
-            it = symbol_set_.erase(it);
+    // new entry leads to all final nodes, and the start node becomes tail
+    auto node = model->AddNode();
+    for (NFAIndex i = 0; i < nodes_.size(); ++i) {
+        if (node_tokens_[i] >= 0) {
+            model->ConnectEdge(node, model->AddEdge(kNFANone, i));
         }
-        else {
-            ++it;
+    }
+    model->set_entry(model->AddEdge(kNFANone, node));
+    model->set_tail(start());
+    return model;
+}
+
+int NFAModel::GetToken(const std::vector<NFAIndex> &nodes) const {
+    int token = -1;
+    for (const auto &node : nodes) {
+        auto cur_token = node_tokens_[node];
+        if (cur_token >= 0 && (token < 0 || cur_token < token)) {
+            token = cur_token;
         }
     }
+    return token;
+}
+
+DFAModelPtr NFAModel::GenerateDFA(std::size_t max_states) {
+    return GenerateDFA(max_states, [this](const std::vector<NFAIndex> &n) {
+        return GetToken(n);
+    });
 }
 
-// a rough implementation of subset construction
-// TODO: optimize
-DFAModelPtr NFAModel::GenerateDFA() {
-    std::deque<NFANodeSet> set_queue;
-    std::unordered_map<NFANodeSet::HashType, DFAStatePtr> state_set;
+// subset construction, DFA states are identified by sorted node lists
+DFAModelPtr NFAModel::GenerateDFA(std::size_t max_states,
+        const std::function<int(const std::vector<NFAIndex> &)>
+                &get_token) {
+    std::unordered_map<NodeList, DFAStatePtr, NodeListHash> state_map;
+    std::deque<const std::pair<const NodeList, DFAStatePtr> *> set_queue;
     auto model = std::make_shared<DFAModel>();
     // define 'Push' operation
-    auto Push = [&set_queue, &state_set](const NFANodeSet &node_set) {
-        // is empty set
-        if (node_set.empty()) return state_set.end();
-        // not unique
-        auto it = state_set.find(node_set.hash_value());
-        if (it != state_set.end()) return it;
-        set_queue.push_back(node_set);
-        // add new DFA state
-        auto new_state = std::make_shared<DFAState>();
-        auto ret = state_set.insert({node_set.hash_value(), new_state});
-        return ret.first;
+    auto Push = [&set_queue, &state_map, &model, &get_token]
+            (NodeList &&nodes) {
+        auto ret = state_map.insert({std::move(nodes), nullptr});
+        if (ret.second) {
+            // add new DFA state
+            const auto &node_list = ret.first->first;
+            auto &new_state = ret.first->second;
+            new_state = std::make_shared<DFAState>();
+            set_queue.push_back(&*ret.first);
+            // current state is a final state of DFA
+            auto token = get_token(node_list);
+            if (token >= 0) {
+                new_state->set_token(token);
+                model->AddFinalState(new_state);
+            }
+            else {
+                model->AddState(new_state);
+            }
+        }
+        return ret.first->second;
     };
     // normalization current NFA
     NormalizeNFA();
+    // get char classes of NFA
+    NFAAlphabet alphabet(*this);
+    auto class_count = alphabet.class_count();
+    model->set_char_class(alphabet.char_class());
     // get initial states set & push into queue
-    auto initial_set = GetEpsilonClosure(entry_->tail());
-    auto it = Push(initial_set);
-    // initialize DFA model
-    model->set_initial(it->second);
-    if (initial_set.find(tail_) != initial_set.end()) {
-        model->AddFinalState(it->second);
-    }
-    else {
-        model->AddState(it->second);
-    }
+    ClosureCache closures(*this);
+    auto initial = closures.GetClosure(start());
+    model->set_initial(Push(std::move(initial)));
     // traversal every unique DFA state
+    std::vector<NodeList> moves;
     while (!set_queue.empty()) {
-        const auto &front = set_queue.front();
-        const auto &cur_state = state_set[front.hash_value()];
-        for (const auto &symbol : symbol_set_) {
-            auto dfa_state = GetDFAState(front, symbol);
-            auto it = Push(dfa_state);
+        const auto &front = set_queue.front()->first;
+        const auto cur_state = set_queue.front()->second;
+        set_queue.pop_front();
+        // get the nodes that can be moved to by each char classes
+        alphabet.GetMoves(*this, front, moves);
+        for (std::size_t cls = 0; cls < class_count; ++cls) {
             // empty state set (adding empty edge)
-            if (it == state_set.end()) continue;
+            if (moves[cls].empty()) continue;
             // add edge to new state
-            auto new_edge = std::make_shared<DFAEdge>(symbol, it->second);
+            const auto &next = Push(closures.GetClosure(moves[cls]));
+            if (max_states && state_map.size() > max_states) return nullptr;
+            const auto &symbol = alphabet.class_symbol(cls);
+            auto new_edge = std::make_shared<DFAEdge>(symbol, cls, next);
             cur_state->AddEdge(new_edge);
-            // current state is a final state of DFA
-            if (dfa_state.find(tail_) != dfa_state.end()) {
-                model->AddFinalState(it->second);
+            // add symbol
+            model->AddSymbol(symbol);
+        }
+    }
+    return model;
+}
+
+// level-synchronous subset construction, all states of current level
+// are expanded in parallel, then the new states are interned in the
+// same order as sequential construction
+DFAModelPtr NFAModel::GenerateDFA(std::size_t max_states,
+        ThreadPool &pool) {
+    using StateMap = std::unordered_map<NodeList, DFAStatePtr, NodeListHash>;
+    StateMap state_map;
+    std::vector<std::pair<const NodeList *, DFAStatePtr>> level, next_level;
+    auto model = std::make_shared<DFAModel>();
+    auto Push = [this, &next_level, &state_map, &model](NodeList &&nodes) {
+        auto ret = state_map.insert({std::move(nodes), nullptr});
+        if (ret.second) {
+            const auto &node_list = ret.first->first;
+            auto &new_state = ret.first->second;
+            new_state = std::make_shared<DFAState>();
+            next_level.push_back({&node_list, new_state});
+            auto token = GetToken(node_list);
+            if (token >= 0) {
+                new_state->set_token(token);
+                model->AddFinalState(new_state);
             }
             else {
-                model->AddState(it->second);
+                model->AddState(new_state);
             }
-            // add symbol
-            model->AddSymbol(symbol);
         }
-        set_queue.pop_front();
+        return ret.first->second;
+    };
+    NormalizeNFA();
+    NFAAlphabet alphabet(*this);
+    auto class_count = alphabet.class_count();
+    model->set_char_class(alphabet.char_class());
+    // closure caches are not thread-safe, each worker has its own
+    std::vector<ClosureCache> closures;
+    closures.reserve(pool.thread_count());
+    for (std::size_t i = 0; i < pool.thread_count(); ++i) {
+        closures.emplace_back(*this);
+    }
+    model->set_initial(Push(NodeList(closures[0].GetClosure(start()))));
+    // target of each state & char class, with the existing DFA state
+    struct Target {
+        NodeList nodes;
+        DFAStatePtr state;
+    };
+    std::vector<std::vector<Target>> targets;
+    while (!next_level.empty()) {
+        level.swap(next_level);
+        next_level.clear();
+        // expand states & look up existing states in parallel,
+        // 'state_map' is read-only at this time
+        targets.resize(level.size());
+        pool.ParallelFor(level.size(), [&](std::size_t i, std::size_t worker) {
+            std::vector<NodeList> moves;
+            alphabet.GetMoves(*this, *level[i].first, moves);
+            auto &target = targets[i];
+            target.resize(class_count);
+            for (std::size_t cls = 0; cls < class_count; ++cls) {
+                target[cls].state.reset();
+                if (moves[cls].empty()) {
+                    target[cls].nodes.clear();
+                    continue;
+                }
+                target[cls].nodes = closures[worker].GetClosure(moves[cls]);
+                auto it = state_map.find(target[cls].nodes);
+                if (it != state_map.end()) {
+                    // only keep the nodes of new states
+                    target[cls].state = it->second;
+                    NodeList().swap(target[cls].nodes);
+                }
+            }
+        });
+        // add edges & intern new states in order
+        for (std::size_t i = 0; i < level.size(); ++i) {
+            for (std::size_t cls = 0; cls < class_count; ++cls) {
+                auto &target = targets[i][cls];
+                if (!target.state && target.nodes.empty()) continue;
+                auto next = target.state ? target.state
+                                         : Push(std::move(target.nodes));
+                if (max_states && state_map.size() > max_states) {
+                    return nullptr;
+                }
+                const auto &symbol = alphabet.class_symbol(cls);
+                auto edge = std::make_shared<DFAEdge>(symbol, cls, next);
+                level[i].second->AddEdge(edge);
+                model->AddSymbol(symbol);
+            }
+            // release targets as soon as they are merged
+            std::vector<Target>().swap(targets[i]);
+        }
     }
     return model;
 }
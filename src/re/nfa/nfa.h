@@ -3,98 +3,225 @@
 
 #include <memory>
 #include <utility>
-#include <list>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <cassert>
 
 #include <re/util/charset.h>
 #include <re/dfa/dfa.h>
+#include <re/util/pool.h>
 
 namespace rex::re {
 
-class NFAEdge;
-class NFANode;
 class NFAModel;
 
-using NFAEdgePtr = std::shared_ptr<NFAEdge>;
-using NFANodePtr = std::shared_ptr<NFANode>;
 using NFAModelPtr = std::shared_ptr<NFAModel>;
 
-class NFAEdge {
-public:
-    NFAEdge(const SymbolPtr &symbol, const NFANodePtr &tail)
-            : symbol_(symbol), tail_(tail) {}
-    ~NFAEdge() {}
+// index of nodes, edges and symbols in NFA model
+using NFAIndex = std::uint32_t;
 
-    void set_symbol(const SymbolPtr &symbol) { symbol_ = symbol; }
-    const SymbolPtr &symbol() const { return symbol_; }
-    const NFANodePtr &tail() const { return tail_; }
+// invalid index, also used as the symbol of epsilon edges
+constexpr NFAIndex kNFANone = ~static_cast<NFAIndex>(0);
 
-private:
-    SymbolPtr symbol_;
-    NFANodePtr tail_;
+// all nodes & edges are stored in the arena of NFA model,
+// and reference each other by index
+struct NFAEdge {
+    NFAIndex symbol, tail;
+    // next out edge of the same node
+    NFAIndex next;
 };
 
-class NFANode {
-public:
-    NFANode() {}
-    ~NFANode() {}
-
-    void AddEdge(const NFAEdgePtr &edge) { out_edges_.push_back(edge); }
-
-    void Release() {
-        if (out_edges_.empty()) return;
-        auto edges = out_edges_;
-        out_edges_.clear();
-        for (auto &&i : edges) i->tail()->Release();
-    }
+struct NFANode {
+    NFAIndex first_edge, last_edge;
+};
 
-    const std::list<NFAEdgePtr> &out_edges() const { return out_edges_; }
+// compact representation of out edges
+struct NFAArc {
+    NFAIndex symbol, tail;
+};
 
-private:
-    std::list<NFAEdgePtr> out_edges_;
+// part of NFA, represented by entry edge & tail node
+struct NFAFragment {
+    NFAIndex entry, tail;
 };
 
 class NFAModel {
 public:
-    NFAModel() {}
+    NFAModel()
+            : entry_(kNFANone), tail_(kNFANone), max_repeat_(0),
+              normalized_(false) {}
     ~NFAModel() {}
 
-    void AddSymbol(const SymbolPtr &symbol) {
-        symbol_set_.insert(symbol);
+    NFAIndex AddNode() {
+        normalized_ = false;
+        nodes_.push_back({kNFANone, kNFANone});
+        return nodes_.size() - 1;
+    }
+
+    // create an edge that has not been connected to any nodes
+    NFAIndex AddEdge(NFAIndex symbol, NFAIndex tail) {
+        normalized_ = false;
+        edges_.push_back({symbol, tail, kNFANone});
+        return edges_.size() - 1;
     }
 
-    void AddSymbolSet(const SymbolSet &symbol_set) {
-        for (const auto &symbol : symbol_set) {
-            symbol_set_.insert(symbol);
+    // append edge to the out edges of node
+    void ConnectEdge(NFAIndex node, NFAIndex edge) {
+        normalized_ = false;
+        auto &cur_node = nodes_[node];
+        if (cur_node.last_edge == kNFANone) {
+            cur_node.first_edge = edge;
         }
+        else {
+            edges_[cur_node.last_edge].next = edge;
+        }
+        cur_node.last_edge = edge;
+    }
+
+    // add symbol to symbol table, returns index of symbol
+    NFAIndex AddSymbol(const SymbolPtr &symbol) {
+        if (!symbol) return kNFANone;
+        auto ret = symbol_ids_.insert({symbol, symbols_.size()});
+        if (ret.second) symbols_.push_back(symbol);
+        return ret.first->second;
+    }
+
+    // attach a tag to an epsilon edge, tags are only used by the
+    // engines that extract submatches, and are ignored by others
+    // NOTE:  tags will not be copied to the reversed model
+    void SetTag(NFAIndex edge, NFAIndex tag) {
+        assert(edges_[edge].symbol == kNFANone);
+        normalized_ = false;
+        edge_tags_[edge] = tag;
+    }
+
+    // copy a fragment whose nodes & edges are stored contiguously in
+    // '[node_begin, node_end)' & '[edge_begin, edge_end)',
+    // returns the new fragment
+    // NOTE:  nodes of fragment must not be connected to outside edges
+    NFAFragment CopyFragment(const NFAFragment &fragment,
+            NFAIndex node_begin, NFAIndex node_end,
+            NFAIndex edge_begin, NFAIndex edge_end);
+
+    // record a bounded repetition with 'count' copies of sub-NFA
+    void AddRepeat(std::size_t count) {
+        if (count > max_repeat_) max_repeat_ = count;
+    }
+
+    // mark node as a final node with specific token, the tail node
+    // will be the only final node (with token 0) if no node is marked
+    void AddFinalNode(NFAIndex node, int token) {
+        normalized_ = false;
+        final_nodes_.push_back({node, token});
     }
 
+    // free all nodes & edges in one shot
     void Release() {
-        entry_->tail()->Release();
-        entry_.reset();
-        tail_.reset();
-        symbol_set_.clear();
+        entry_ = tail_ = kNFANone;
+        max_repeat_ = 0;
+        normalized_ = false;
+        decltype(final_nodes_)().swap(final_nodes_);
+        decltype(node_tokens_)().swap(node_tokens_);
+        decltype(nodes_)().swap(nodes_);
+        decltype(edges_)().swap(edges_);
+        decltype(arc_offsets_)().swap(arc_offsets_);
+        decltype(arcs_)().swap(arcs_);
+        decltype(arc_tags_)().swap(arc_tags_);
+        edge_tags_.clear();
+        symbols_.clear();
+        symbol_ids_.clear();
+    }
+
+    // add entry node & build compact adjacency list,
+    // does nothing if model has not been modified since last call
+    void NormalizeNFA();
+    // add a prefix that matches any string ('.*') to current model,
+    // so that the model can match anywhere in the input
+    void MakeUnanchored();
+    // generate a model that matches the reverse of strings,
+    // NFA model must be normalized
+    NFAModelPtr GenerateReverse() const;
+    // generate DFA by subset construction, returns null if
+    // 'max_states' is not zero and the DFA exceeds this limit
+    DFAModelPtr GenerateDFA(std::size_t max_states = 0);
+    // same as above, but token of each DFA state is given by
+    // 'get_token(nodes)' instead of the smallest token of nodes
+    DFAModelPtr GenerateDFA(std::size_t max_states,
+            const std::function<int(const std::vector<NFAIndex> &)>
+                    &get_token);
+    // same as above, but states are expanded by the threads of 'pool',
+    // the result does not depend on the count of threads
+    DFAModelPtr GenerateDFA(std::size_t max_states, ThreadPool &pool);
+
+    // out edges of node in compact adjacency layout
+    // NOTE:  only available after normalization
+    const NFAArc *arc_begin(NFAIndex node) const {
+        return arcs_.data() + arc_offsets_[node];
+    }
+    const NFAArc *arc_end(NFAIndex node) const {
+        return arcs_.data() + arc_offsets_[node + 1];
     }
 
-    DFAModelPtr GenerateDFA();
+    // tag of edge or arc, 'kNFANone' if there is no tag
+    NFAIndex edge_tag(NFAIndex edge) const {
+        auto it = edge_tags_.find(edge);
+        return it != edge_tags_.end() ? it->second : kNFANone;
+    }
+    NFAIndex arc_tag(const NFAArc *arc) const {
+        return arc_tags_.empty() ? kNFANone : arc_tags_[arc - arcs_.data()];
+    }
+    bool has_tags() const { return !edge_tags_.empty(); }
 
-    void set_entry(const NFAEdgePtr &entry) {
+    void set_entry(NFAIndex entry) {
+        normalized_ = false;
         entry_ = entry;
     }
-
-    void set_tail(const NFANodePtr &tail) {
+    void set_tail(NFAIndex tail) {
+        normalized_ = false;
         tail_ = tail;
     }
 
-    const NFAEdgePtr &entry() const { return entry_; }
-    const NFANodePtr &tail() const { return tail_; }
-    const SymbolSet &symbol_set() const { return symbol_set_; }
+    NFAIndex entry() const { return entry_; }
+    NFAIndex tail() const { return tail_; }
+    // the node that matching starts from, available after normalization
+    NFAIndex start() const { return edges_[entry_].tail; }
+    // token of node (-1 if node is not final), available after normalization
+    int token(NFAIndex node) const { return node_tokens_[node]; }
+    // get the token with the highest priority of nodes
+    int GetToken(const std::vector<NFAIndex> &nodes) const;
+    NFAEdge &edge(NFAIndex index) {
+        normalized_ = false;
+        return edges_[index];
+    }
+    const NFAEdge &edge(NFAIndex index) const { return edges_[index]; }
+    const NFANode &node(NFAIndex index) const { return nodes_[index]; }
+    const SymbolPtr &symbol(NFAIndex index) const {
+        static const SymbolPtr epsilon;
+        return index == kNFANone ? epsilon : symbols_[index];
+    }
+    std::size_t node_count() const { return nodes_.size(); }
+    std::size_t edge_count() const { return edges_.size(); }
+    std::size_t symbol_count() const { return symbols_.size(); }
+    // the largest count of copies of all bounded repetitions
+    std::size_t max_repeat() const { return max_repeat_; }
 
 private:
-    void NormalizeNFA();
-
-    NFAEdgePtr entry_;
-    NFANodePtr tail_;
-    SymbolSet symbol_set_;
+    std::vector<NFANode> nodes_;
+    std::vector<NFAEdge> edges_;
+    std::vector<SymbolPtr> symbols_;
+    std::unordered_map<SymbolPtr, NFAIndex,
+                       SymbolHash, SymbolEqual> symbol_ids_;
+    std::vector<NFAIndex> arc_offsets_;
+    std::vector<NFAArc> arcs_;
+    std::unordered_map<NFAIndex, NFAIndex> edge_tags_;
+    std::vector<NFAIndex> arc_tags_;
+    std::vector<std::pair<NFAIndex, int>> final_nodes_;
+    std::vector<int> node_tokens_;
+    NFAIndex entry_, tail_;
+    std::size_t max_repeat_;
+    bool normalized_;
 };
 
 } // namespace rex::re
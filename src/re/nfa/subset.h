@@ -0,0 +1,177 @@
+#ifndef REX_RE_NFA_SUBSET_H_
+#define REX_RE_NFA_SUBSET_H_
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/nfa/nfa.h>
+#include <re/util/charset.h>
+#include <re/util/charclass.h>
+#include <re/util/util.h>
+
+// helpers of subset construction, shared by all DFA engines
+
+namespace rex::re {
+
+// sorted list of NFA nodes, identifies a DFA state exactly
+using NodeList = std::vector<NFAIndex>;
+
+struct NodeListHash {
+    std::size_t operator()(const NodeList &nodes) const {
+        std::size_t hash_val = nodes.size();
+        for (const auto &i : nodes) HashCombile(hash_val, i);
+        return hash_val;
+    }
+};
+
+// epsilon closures of NFA nodes, each closure will only be computed once
+// NOTE:  NFA model must be normalized
+class ClosureCache {
+public:
+    ClosureCache(const NFAModel &nfa)
+            : nfa_(nfa), closures_(nfa.node_count()),
+              computed_(nfa.node_count(), false),
+              marks_(nfa.node_count(), 0), stamp_(0) {}
+
+    // get epsilon closure of a single node
+    const NodeList &GetClosure(NFAIndex node) {
+        auto &closure = closures_[node];
+        if (computed_[node]) return closure;
+        // depth-first search along epsilon edges
+        NextStamp();
+        std::vector<NFAIndex> node_stack = {node};
+        marks_[node] = stamp_;
+        while (!node_stack.empty()) {
+            auto cur_node = node_stack.back();
+            node_stack.pop_back();
+            closure.push_back(cur_node);
+            for (auto arc = nfa_.arc_begin(cur_node);
+                    arc != nfa_.arc_end(cur_node); ++arc) {
+                if (arc->symbol == kNFANone && marks_[arc->tail] != stamp_) {
+                    marks_[arc->tail] = stamp_;
+                    node_stack.push_back(arc->tail);
+                }
+            }
+        }
+        std::sort(closure.begin(), closure.end());
+        computed_[node] = true;
+        return closure;
+    }
+
+    // get the union of epsilon closures of nodes
+    NodeList GetClosure(const NodeList &nodes) {
+        for (const auto &node : nodes) GetClosure(node);
+        NextStamp();
+        NodeList node_list;
+        for (const auto &node : nodes) {
+            for (const auto &i : closures_[node]) {
+                if (marks_[i] != stamp_) {
+                    marks_[i] = stamp_;
+                    node_list.push_back(i);
+                }
+            }
+        }
+        std::sort(node_list.begin(), node_list.end());
+        return node_list;
+    }
+
+private:
+    void NextStamp() {
+        if (!++stamp_) {
+            std::fill(marks_.begin(), marks_.end(), 0);
+            stamp_ = 1;
+        }
+    }
+
+    const NFAModel &nfa_;
+    std::vector<NodeList> closures_;
+    std::vector<bool> computed_;
+    std::vector<std::uint32_t> marks_;
+    std::uint32_t stamp_;
+};
+
+// char classes of NFA, and the classes accepted by each symbol
+// NOTE:  NFA model must be normalized
+class NFAAlphabet {
+public:
+    NFAAlphabet(const NFAModel &nfa)
+            : symbol_classes_(nfa.symbol_count()) {
+        // get char sets of all symbols that used by edges
+        std::vector<CharSet> symbol_sets(nfa.symbol_count());
+        std::vector<bool> used(nfa.symbol_count(), false);
+        for (NFAIndex node = 0; node < nfa.node_count(); ++node) {
+            for (auto arc = nfa.arc_begin(node);
+                    arc != nfa.arc_end(node); ++arc) {
+                if (arc->symbol == kNFANone || used[arc->symbol]) continue;
+                used[arc->symbol] = true;
+                symbol_sets[arc->symbol].InsertSymbol(nfa.symbol(arc->symbol));
+            }
+        }
+        // split all byte values into equivalence classes
+        for (const auto &char_set : symbol_sets) char_class_.Split(char_set);
+        char_class_.Normalize();
+        // get the char classes that accepted by each symbols,
+        // and make symbols for all accepted char classes
+        class_symbols_.resize(char_class_.class_count());
+        for (std::size_t cls = 0; cls < char_class_.class_count(); ++cls) {
+            auto c = char_class_.GetRepresentative(cls);
+            for (std::size_t i = 0; i < symbol_sets.size(); ++i) {
+                if (!used[i] || !symbol_sets[i].Include(c)) continue;
+                symbol_classes_[i].push_back(cls);
+                if (!class_symbols_[cls]) {
+                    auto char_set = char_class_.GetCharSet(cls);
+                    class_symbols_[cls] = char_set.MakeSymbol();
+                }
+            }
+        }
+    }
+
+    // get the nodes that can be moved to from 'nodes' by each char class
+    void GetMoves(const NFAModel &nfa, const NodeList &nodes,
+            std::vector<NodeList> &moves) const {
+        moves.resize(char_class_.class_count());
+        for (auto &&i : moves) i.clear();
+        for (const auto &node : nodes) {
+            for (auto arc = nfa.arc_begin(node);
+                    arc != nfa.arc_end(node); ++arc) {
+                if (arc->symbol == kNFANone) continue;
+                for (const auto &cls : symbol_classes_[arc->symbol]) {
+                    moves[cls].push_back(arc->tail);
+                }
+            }
+        }
+    }
+
+    // get the nodes that can be moved to from 'nodes' by a char class
+    void GetMove(const NFAModel &nfa, const NodeList &nodes,
+            std::size_t cls, NodeList &move) const {
+        move.clear();
+        for (const auto &node : nodes) {
+            for (auto arc = nfa.arc_begin(node);
+                    arc != nfa.arc_end(node); ++arc) {
+                if (arc->symbol == kNFANone) continue;
+                const auto &classes = symbol_classes_[arc->symbol];
+                if (std::binary_search(classes.begin(), classes.end(), cls)) {
+                    move.push_back(arc->tail);
+                }
+            }
+        }
+    }
+
+    const CharClassMap &char_class() const { return char_class_; }
+    std::size_t class_count() const { return char_class_.class_count(); }
+    const SymbolPtr &class_symbol(std::size_t cls) const {
+        return class_symbols_[cls];
+    }
+
+private:
+    CharClassMap char_class_;
+    std::vector<std::vector<std::size_t>> symbol_classes_;
+    std::vector<SymbolPtr> class_symbols_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_NFA_SUBSET_H_
@@ -0,0 +1,381 @@
+#include <re/parser/parser.h>
+
+#include <vector>
+#include <utility>
+
+namespace {
+
+using namespace rex::re;
+
+// chars that must be escaped outside & inside of char class
+constexpr std::string_view kMetaChars = "\\.^$|()[]{}*+?";
+constexpr std::string_view kClassMetaChars = "\\[]^-";
+
+// state of a group that is being parsed
+struct Frame {
+    // index of capture group, 0 if group is not capturing
+    std::size_t group = 0;
+    // position of '(' in pattern
+    std::size_t pos = 0;
+    // alternatives before the last '|', current sequence,
+    // and the last atom of sequence, with their normalized texts
+    REObject alt, seq, atom;
+    std::string alt_text, seq_text, atom_text;
+    // there is a '|' in group
+    bool has_alt = false;
+    // the last atom has been repeated
+    bool repeated = false;
+};
+
+inline bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool IsAlnum(char c) {
+    return IsDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline int GetHexValue(char c) {
+    if (IsDigit(c)) return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// get the only char in set, -1 if set does not have exactly one char
+int GetSingleChar(const CharSet &set) {
+    int ret = -1;
+    for (int c = 0; c < 256; ++c) {
+        if (!set.Include(c)) continue;
+        if (ret >= 0) return -1;
+        ret = c;
+    }
+    return ret;
+}
+
+// append char to text, escape it if it is not printable or special
+void AppendChar(std::string &text, int c, std::string_view specials) {
+    static const char kHexDigits[] = "0123456789abcdef";
+    if (c >= 0x20 && c < 0x7f) {
+        if (specials.find(c) != std::string_view::npos) text += '\\';
+        text += c;
+    }
+    else {
+        text += "\\x";
+        text += kHexDigits[c >> 4];
+        text += kHexDigits[c & 0xf];
+    }
+}
+
+// get normalized text of char set, chars are stored as sorted ranges
+std::string GetSetText(const CharSet &set) {
+    std::string text;
+    auto single = GetSingleChar(set);
+    if (single >= 0) {
+        AppendChar(text, single, kMetaChars);
+        return text;
+    }
+    CharSet any;
+    any.Reverse();
+    any.Remove('\n');
+    if (set == any) return ".";
+    // negate the class if it is shorter
+    int count = 0;
+    for (int c = 0; c < 256; ++c) count += set.Include(c);
+    bool negate = count > 128;
+    text = negate ? "[^" : "[";
+    for (int c = 0; c < 256;) {
+        if (set.Include(c) == negate) {
+            ++c;
+            continue;
+        }
+        auto first = c;
+        while (c < 256 && set.Include(c) != negate) ++c;
+        AppendChar(text, first, kClassMetaChars);
+        if (c - first > 2) text += '-';
+        if (c - first > 1) AppendChar(text, c - 1, kClassMetaChars);
+    }
+    text += ']';
+    return text;
+}
+
+// append the last atom to sequence
+void FoldAtom(Frame &frame) {
+    if (!frame.atom) return;
+    frame.seq = frame.seq ? frame.seq & frame.atom : frame.atom;
+    frame.seq_text += frame.atom_text;
+    frame.atom = REObject();
+    frame.atom_text.clear();
+}
+
+// append current sequence to alternatives
+void FoldSeq(Frame &frame) {
+    FoldAtom(frame);
+    auto seq = frame.seq ? frame.seq : Nil();
+    if (!frame.has_alt) {
+        frame.alt = seq;
+        frame.alt_text = frame.seq_text;
+    }
+    else {
+        frame.alt = frame.alt | seq;
+        frame.alt_text += '|' + frame.seq_text;
+    }
+    frame.seq = REObject();
+    frame.seq_text.clear();
+}
+
+void PushAtom(Frame &frame, REObject atom, std::string text) {
+    FoldAtom(frame);
+    frame.atom = std::move(atom);
+    frame.atom_text = std::move(text);
+    frame.repeated = false;
+}
+
+void RepeatAtom(Frame &frame, std::size_t min, std::size_t max) {
+    auto &atom = frame.atom;
+    auto &text = frame.atom_text;
+    frame.repeated = true;
+    if (min == 1 && max == 1) return;
+    if (min == 0 && max == kRepeatInf) {
+        atom = atom.Many();
+        text += '*';
+    }
+    else if (min == 1 && max == kRepeatInf) {
+        atom = atom.Repeat(1, kRepeatInf);
+        text += '+';
+    }
+    else if (min == 0 && max == 1) {
+        atom = atom.Optional();
+        text += '?';
+    }
+    else {
+        atom = atom.Repeat(min, max);
+        text += '{' + std::to_string(min);
+        if (min != max) {
+            text += ',';
+            if (max != kRepeatInf) text += std::to_string(max);
+        }
+        text += '}';
+    }
+}
+
+} // namespace
+
+namespace rex::re {
+
+REObject Parser::Parse() {
+    pos_ = group_count_ = 0;
+    normalized_.clear();
+    std::vector<Frame> frames(1);
+    while (pos_ < pattern_.size()) {
+        auto c = pattern_[pos_];
+        switch (c) {
+            case '(': {
+                Frame frame;
+                frame.pos = pos_++;
+                if (pattern_.substr(pos_, 2) == "?:") {
+                    frame.group = 0;
+                    pos_ += 2;
+                }
+                else if (pos_ < pattern_.size() && pattern_[pos_] == '?') {
+                    return REObject();
+                }
+                else {
+                    frame.group = ++group_count_;
+                }
+                frames.push_back(std::move(frame));
+                break;
+            }
+            case ')': {
+                if (frames.size() == 1) return REObject();
+                ++pos_;
+                auto frame = std::move(frames.back());
+                frames.pop_back();
+                FoldSeq(frame);
+                if (frame.group) {
+                    PushAtom(frames.back(), Capture(frame.alt, frame.group),
+                             '(' + frame.alt_text + ')');
+                }
+                else {
+                    PushAtom(frames.back(), frame.alt,
+                             "(?:" + frame.alt_text + ')');
+                }
+                break;
+            }
+            case '|': {
+                ++pos_;
+                FoldSeq(frames.back());
+                frames.back().has_alt = true;
+                break;
+            }
+            case '*': case '+': case '?': case '{': {
+                auto &frame = frames.back();
+                if (!frame.atom || frame.repeated) return REObject();
+                ++pos_;
+                std::size_t min = c == '+', max = kRepeatInf;
+                if (c == '?') max = 1;
+                if (c == '{' && !ParseCount(min, max)) return REObject();
+                // lazy repetitions are not supported
+                if (pos_ < pattern_.size() && pattern_[pos_] == '?') {
+                    return REObject();
+                }
+                RepeatAtom(frame, min, max);
+                break;
+            }
+            case '^': case '$': {
+                // anchors are not supported
+                return REObject();
+            }
+            default: {
+                CharSet set;
+                ++pos_;
+                if (c == '[') {
+                    if (!ParseClass(set)) return REObject();
+                }
+                else if (c == '\\') {
+                    if (!ParseEscape(set)) return REObject();
+                }
+                else if (c == '.') {
+                    set.Reverse();
+                    set.Remove('\n');
+                }
+                else {
+                    set.Insert(c);
+                }
+                auto atom = REObject(new RESymbolObj(set.MakeSymbol()));
+                PushAtom(frames.back(), std::move(atom), GetSetText(set));
+                break;
+            }
+        }
+    }
+    // check unclosed groups
+    if (frames.size() > 1) {
+        pos_ = frames.back().pos;
+        return REObject();
+    }
+    FoldSeq(frames.back());
+    normalized_ = std::move(frames.back().alt_text);
+    return frames.back().alt;
+}
+
+bool Parser::ParseEscape(CharSet &set) {
+    if (pos_ >= pattern_.size()) return false;
+    auto c = pattern_[pos_++];
+    switch (c) {
+        case 'd': case 'D': {
+            for (char i = '0'; i <= '9'; ++i) set.Insert(i);
+            break;
+        }
+        case 'w': case 'W': {
+            set.InsertLambda([](char ch) { return IsAlnum(ch) || ch == '_'; });
+            break;
+        }
+        case 's': case 'S': {
+            for (const auto &i : std::string_view(" \t\n\r\f\v")) {
+                set.Insert(i);
+            }
+            break;
+        }
+        case 'n': set.Insert('\n'); break;
+        case 'r': set.Insert('\r'); break;
+        case 't': set.Insert('\t'); break;
+        case 'f': set.Insert('\f'); break;
+        case 'v': set.Insert('\v'); break;
+        case '0': set.Insert('\0'); break;
+        case 'x': {
+            if (pos_ + 2 > pattern_.size()) return false;
+            auto hi = GetHexValue(pattern_[pos_]);
+            auto lo = GetHexValue(pattern_[pos_ + 1]);
+            if (hi < 0 || lo < 0) return false;
+            set.Insert(static_cast<char>(hi * 16 + lo));
+            pos_ += 2;
+            break;
+        }
+        default: {
+            // other letters & digits are reserved
+            if (IsAlnum(c)) {
+                --pos_;
+                return false;
+            }
+            set.Insert(c);
+            break;
+        }
+    }
+    // negated classes
+    if (c == 'D' || c == 'W' || c == 'S') set.Reverse();
+    return true;
+}
+
+bool Parser::ParseClass(CharSet &set) {
+    bool negate = false;
+    if (pos_ < pattern_.size() && pattern_[pos_] == '^') {
+        negate = true;
+        ++pos_;
+    }
+    // ']' at the beginning of class is treated as a char
+    for (bool first = true;; first = false) {
+        if (pos_ >= pattern_.size()) return false;
+        if (pattern_[pos_] == ']' && !first) break;
+        // get the lower bound of range, or an escaped class
+        CharSet lower;
+        if (pattern_[pos_] == '\\') {
+            ++pos_;
+            if (!ParseEscape(lower)) return false;
+        }
+        else {
+            lower.Insert(pattern_[pos_++]);
+        }
+        auto lo = GetSingleChar(lower);
+        if (lo < 0 || pos_ + 1 >= pattern_.size() ||
+                pattern_[pos_] != '-' || pattern_[pos_ + 1] == ']') {
+            set.Merge(lower);
+            continue;
+        }
+        // get the upper bound of range
+        ++pos_;
+        CharSet upper;
+        if (pattern_[pos_] == '\\') {
+            ++pos_;
+            if (!ParseEscape(upper)) return false;
+        }
+        else {
+            upper.Insert(pattern_[pos_++]);
+        }
+        auto hi = GetSingleChar(upper);
+        if (hi < lo) {
+            --pos_;
+            return false;
+        }
+        for (auto i = lo; i <= hi; ++i) set.Insert(i);
+    }
+    ++pos_;
+    if (negate) set.Reverse();
+    return !set.Empty();
+}
+
+bool Parser::ParseNumber(std::size_t &num) {
+    if (pos_ >= pattern_.size() || !IsDigit(pattern_[pos_])) return false;
+    num = 0;
+    while (pos_ < pattern_.size() && IsDigit(pattern_[pos_])) {
+        num = num * 10 + (pattern_[pos_++] - '0');
+        if (num > kMaxRepeat) return false;
+    }
+    return true;
+}
+
+bool Parser::ParseCount(std::size_t &min, std::size_t &max) {
+    if (!ParseNumber(min)) return false;
+    max = min;
+    if (pos_ < pattern_.size() && pattern_[pos_] == ',') {
+        ++pos_;
+        max = kRepeatInf;
+        if (pos_ < pattern_.size() && IsDigit(pattern_[pos_])) {
+            if (!ParseNumber(max) || max < min) return false;
+        }
+    }
+    if (pos_ >= pattern_.size() || pattern_[pos_] != '}') return false;
+    ++pos_;
+    return true;
+}
+
+} // namespace rex::re
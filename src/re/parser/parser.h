@@ -0,0 +1,72 @@
+#ifndef REX_RE_PARSER_PARSER_H_
+#define REX_RE_PARSER_PARSER_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+#include <re/reobj/reobj.h>
+#include <re/util/charset.h>
+
+// parser of regular expressions in text form, supported syntax:
+//
+//   x          literal char (non-ASCII bytes are treated as chars)
+//   .          any char except '\n'
+//   [abc]      char class, '[^abc]' for negated class, e.g. '[a-z_]'
+//   \d \w \s   digits, word chars & spaces ('\D' '\W' '\S' for negated)
+//   \n \r \t \f \v \0 \xHH \.   escapes (also available in class)
+//   xy  x|y    concatenation & alternation
+//   (x)        capture group, numbered by the order of '('
+//   (?:x)      non-capturing group
+//   x* x+ x?   repetitions (always greedy)
+//   x{m} x{m,} x{m,n}           counted repetitions
+//
+// NOTE:  anchors, lazy repetitions & backreferences are not supported,
+//        parser is driven by an explicit stack, so deeply nested groups
+//        will not overflow the call stack
+
+namespace rex::re {
+
+class Parser;
+
+using ParserPtr = std::shared_ptr<Parser>;
+
+class Parser {
+public:
+    // counted repetitions with larger bound are rejected
+    static constexpr std::size_t kMaxRepeat = 1000;
+
+    Parser(std::string_view pattern)
+            : pattern_(pattern), pos_(0), group_count_(0) {}
+    ~Parser() {}
+
+    // parse pattern, returns null if pattern is invalid
+    REObject Parse();
+
+    // position of error in pattern, available if failed to parse
+    std::size_t error_pos() const { return pos_; }
+    // normalized text of pattern, same patterns have the same text,
+    // e.g. '[cba]' & '[a-c]', available after parsing
+    const std::string &normalized() const { return normalized_; }
+    // count of capture groups, not including group 0
+    std::size_t group_count() const { return group_count_; }
+
+private:
+    // parse an escape after '\', stores chars to 'set'
+    bool ParseEscape(CharSet &set);
+    // parse a char class after '[', stores chars to 'set'
+    bool ParseClass(CharSet &set);
+    // parse a decimal number
+    bool ParseNumber(std::size_t &num);
+    // parse quantifier '{m}', '{m,}' or '{m,n}' after '{'
+    bool ParseCount(std::size_t &min, std::size_t &max);
+
+    std::string_view pattern_;
+    std::size_t pos_, group_count_;
+    std::string normalized_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_PARSER_PARSER_H_
@@ -2,5 +2,19 @@
 #define REX_RE_RE_H_
 
 #include <re/reobj/reobj.h>
+#include <re/lazy/lazy.h>
+#include <re/regex/regex.h>
+#include <re/lexer/lexer.h>
+#include <re/stream/stream.h>
+#include <re/search/search.h>
+#include <re/multi/multi.h>
+#include <re/codegen/codegen.h>
+#include <re/ct/ct.h>
+#include <re/binary/binary.h>
+#include <re/capture/capture.h>
+#include <re/parser/parser.h>
+#include <re/cache/cache.h>
+#include <re/stats/stats.h>
+#include <re/set/set.h>
 
 #endif // REX_RE_RE_H_
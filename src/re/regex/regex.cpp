@@ -0,0 +1,161 @@
+#include <re/regex/regex.h>
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+namespace {
+
+using namespace rex::re;
+
+// split strings into batches of 'kBatchSize', and run 'test' with the
+// first index & count of each batch by the threads of pool,
+// batches are aligned to words of result bitmap
+template <typename Test>
+void RunBatches(std::size_t count, ThreadPool *pool, Test test) {
+    if (!pool) {
+        test(0, count);
+        return;
+    }
+    auto size = Regex::kBatchSize;
+    auto batch_count = (count + size - 1) / size;
+    pool->ParallelFor(batch_count, [count, size, &test](std::size_t i,
+            std::size_t) {
+        auto first = i * size;
+        test(first, std::min(size, count - first));
+    });
+}
+
+} // namespace
+
+namespace rex::re {
+
+Regex::Regex(const REObject &reo, Engine engine, CompileStats *stats)
+        : engine_(engine) {
+    NFAModelPtr nfa;
+    {
+        PhaseTimer timer(stats, &CompileStats::nfa_time);
+        nfa = reo->GenerateNFA();
+    }
+    RecordNFA(stats, *nfa);
+    {
+        PhaseTimer timer(stats, &CompileStats::normalize_time);
+        nfa->NormalizeNFA();
+    }
+    // large pattern can not be compiled to DFA efficiently
+    if (engine_ == Engine::Auto) {
+        auto small = nfa->node_count() <= kMaxDFANodes &&
+                     nfa->max_repeat() <= kMaxDFARepeat;
+        engine_ = small ? Engine::DFA : Engine::NFA;
+    }
+    if (engine_ == Engine::DFA) {
+        // limit the size of DFA only if engine is selected automatically
+        auto max_states = engine == Engine::Auto ? kMaxDFAStates : 0;
+        DFAModelPtr dfa;
+        {
+            PhaseTimer timer(stats, &CompileStats::dfa_time);
+            dfa = nfa->GenerateDFA(max_states);
+        }
+        if (dfa) {
+            RecordDFA(stats, *dfa, false);
+            {
+                PhaseTimer timer(stats, &CompileStats::simplify_time);
+                dfa->Simplify();
+            }
+            RecordDFA(stats, *dfa, true);
+            PhaseTimer timer(stats, &CompileStats::build_time);
+            table_ = dfa->GenerateStateTable();
+        }
+        else {
+            // state explosion, fall back to NFA engine
+            engine_ = Engine::NFA;
+        }
+    }
+    if (table_) RecordTable(stats, *table_);
+    if (table_ && table_->state_count() <= ShuffleTable::kMaxStates &&
+            HasSSSE3()) {
+        shuffle_ = std::make_shared<ShuffleTable>(*table_);
+    }
+    if (engine_ == Engine::NFA) {
+        PhaseTimer timer(stats, &CompileStats::build_time);
+        vm_ = std::make_shared<PikeVM>(nfa);
+    }
+}
+
+bool Regex::TestString(const char *str, std::size_t len) const {
+    if (shuffle_) return shuffle_->TestString(str, len);
+    return table_ ? table_->TestString(str, len)
+                  : vm_->TestString(str, len);
+}
+
+// NOTE:  chunks except the first one are run from all states of DFA
+//        (enumerative parallelization), then the state maps of chunks
+//        are composed in order, NFA engine always runs sequentially
+bool Regex::TestString(const char *str, std::size_t len,
+        ThreadPool &pool) const {
+    auto chunk_count = std::min(pool.thread_count(), len / kMinChunkSize);
+    if (!table_ || chunk_count <= 1) return TestString(str, len);
+    const auto &table = *table_;
+    auto chunk_size = len / chunk_count;
+    StateTable::StateId state = 0;
+    std::vector<std::vector<StateTable::StateId>> maps(chunk_count);
+    // set once the result is known to be false, to stop other chunks
+    std::atomic<bool> dead(false);
+    pool.ParallelFor(chunk_count, [&](std::size_t i, std::size_t) {
+        auto begin = i * chunk_size;
+        auto end = i + 1 == chunk_count ? len : begin + chunk_size;
+        if (!i) {
+            state = table.Run(table.initial(), str, end);
+            if (!state) dead = true;
+        }
+        else if (table.RunAll(str + begin, end - begin, maps[i], &dead)) {
+            // all states of chunk reach the dead state
+            auto it = std::find_if(maps[i].begin(), maps[i].end(),
+                    [](StateTable::StateId s) { return s; });
+            if (it == maps[i].end()) dead = true;
+        }
+    });
+    if (dead) return false;
+    for (std::size_t i = 1; i < chunk_count && state; ++i) {
+        state = maps[i][table.GetStateIndex(state)];
+    }
+    return state && table.IsAccept(state);
+}
+
+void Regex::TestStrings(const std::string_view *strs, std::size_t count,
+        std::uint64_t *results, ThreadPool *pool) const {
+    RunBatches(count, pool, [&](std::size_t first, std::size_t size) {
+        auto bits = results + first / 64;
+        if (table_) {
+            table_->TestStrings(strs + first, size, bits);
+            return;
+        }
+        for (std::size_t i = 0; i < (size + 63) / 64; ++i) bits[i] = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto &str = strs[first + i];
+            if (vm_->TestString(str.data(), str.size())) {
+                bits[i / 64] |= 1ULL << (i % 64);
+            }
+        }
+    });
+}
+
+void Regex::TestStrings(const char *buffer, const std::size_t *offsets,
+        std::size_t count, std::uint64_t *results, ThreadPool *pool) const {
+    RunBatches(count, pool, [&](std::size_t first, std::size_t size) {
+        auto bits = results + first / 64;
+        if (table_) {
+            table_->TestStrings(buffer, offsets + first, size, bits);
+            return;
+        }
+        for (std::size_t i = 0; i < (size + 63) / 64; ++i) bits[i] = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            auto begin = offsets[first + i], end = offsets[first + i + 1];
+            if (vm_->TestString(buffer + begin, end - begin)) {
+                bits[i / 64] |= 1ULL << (i % 64);
+            }
+        }
+    });
+}
+
+} // namespace rex::re
@@ -0,0 +1,95 @@
+#ifndef REX_RE_REGEX_REGEX_H_
+#define REX_RE_REGEX_REGEX_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/reobj/reobj.h>
+#include <re/util/table.h>
+#include <re/util/shuffle.h>
+#include <re/vm/vm.h>
+#include <re/stats/stats.h>
+#include <re/util/pool.h>
+
+namespace rex::re {
+
+class Regex;
+
+using RegexPtr = std::shared_ptr<Regex>;
+
+// compiled regular expression
+// NOTE:  the matching engine will be selected by the size of pattern
+//        and the size of DFA if engine is 'Auto'
+// NOTE:  small DFAs are also converted to shuffle tables if SSSE3 is
+//        supported by current CPU, which are used for matching single
+//        strings
+class Regex {
+public:
+    enum class Engine {
+        Auto, DFA, NFA
+    };
+
+    // patterns with more NFA nodes will be simulated by NFA directly
+    static constexpr std::size_t kMaxDFANodes = 4096;
+    // patterns with larger bounded repetitions will also be simulated
+    // by NFA, since DFA states may multiply with the count
+    static constexpr std::size_t kMaxDFARepeat = 64;
+    // subset construction will give up if DFA has more states
+    static constexpr std::size_t kMaxDFAStates = 10000;
+
+    // statistics of compilation will be stored to 'stats' if not null
+    Regex(const REObject &reo, Engine engine = Engine::Auto,
+            CompileStats *stats = nullptr);
+    ~Regex() {}
+
+    bool TestString(const char *str, std::size_t len) const;
+    bool TestString(const std::string &str) const {
+        return TestString(str.data(), str.size());
+    }
+
+    // test a large string by splitting it into chunks, which are
+    // matched in parallel by the threads of 'pool', result is always
+    // the same as the sequential one
+    bool TestString(const char *str, std::size_t len,
+            ThreadPool &pool) const;
+    bool TestString(const std::string &str, ThreadPool &pool) const {
+        return TestString(str.data(), str.size(), pool);
+    }
+
+    // test strings in batch, 'strs[i]' is matched if bit 'i % 64'
+    // of 'results[i / 64]' is set, 'results' must have at least
+    // '(count + 63) / 64' words, strings are partitioned to the
+    // threads of 'pool' if it is not null
+    void TestStrings(const std::string_view *strs, std::size_t count,
+            std::uint64_t *results, ThreadPool *pool = nullptr) const;
+    // same as above, but string 'i' is stored in
+    // 'buffer[offsets[i]]' to 'buffer[offsets[i + 1]]'
+    void TestStrings(const char *buffer, const std::size_t *offsets,
+            std::size_t count, std::uint64_t *results,
+            ThreadPool *pool = nullptr) const;
+
+    // selected engine, never be 'Auto'
+    Engine engine() const { return engine_; }
+    // state table of DFA engine, null if using NFA engine
+    const StateTablePtr &table() const { return table_; }
+    // shuffle table of small DFA, null if not available
+    const ShuffleTablePtr &shuffle() const { return shuffle_; }
+
+    // strings in a batch job of thread pool, multiple of 64
+    static constexpr std::size_t kBatchSize = 4096;
+    // strings shorter than this will not be split into chunks
+    static constexpr std::size_t kMinChunkSize = 64 * 1024;
+
+private:
+    Engine engine_;
+    StateTablePtr table_;
+    ShuffleTablePtr shuffle_;
+    PikeVMPtr vm_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_REGEX_REGEX_H_
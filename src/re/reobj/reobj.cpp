@@ -1,6 +1,7 @@
 #include <re/reobj/reobj.h>
 
 #include <cassert>
+#include <algorithm>
 
 namespace rex::re {
 
@@ -15,7 +16,7 @@ REObject Word(const std::string &word) {
         auto cur_char = REObject(new RESymbolObj(symbol));
         reo = reo ? reo & std::move(cur_char) : std::move(cur_char);
     }
-    return std::move(reo);
+    return reo;
 }
 
 REObject Range(char c1, char c2) {
@@ -52,73 +53,132 @@ REObject Optional(REObject reo) {
     return REObject(new REOrObj(std::move(reo), std::move(nil)));
 }
 
-NFAModelPtr RENilObj::GenerateNFA() {
-    auto node = std::make_shared<NFANode>();
-    auto edge = std::make_shared<NFAEdge>(nullptr, node);
-    auto model = std::make_shared<NFAModel>();
-    model->set_entry(edge);
-    model->set_tail(node);
-    return model;
+REObject Repeat(REObject reo, std::size_t min, std::size_t max) {
+    assert(min <= max);
+    return REObject(new RERepeatObj(std::move(reo), min, max));
+}
+
+REObject Capture(REObject reo, std::size_t group) {
+    assert(group > 0);
+    return REObject(new RECaptureObj(std::move(reo), group));
+}
+
+namespace {
+
+// literal info of objects that can match any strings
+inline LiteralInfo GetAnyLiterals() {
+    return {false, "", "", ""};
 }
 
-NFAModelPtr RESymbolObj::GenerateNFA() {
-    auto node = std::make_shared<NFANode>();
-    auto edge = std::make_shared<NFAEdge>(symbol_, node);
+// literal info of objects that only match 'str'
+inline LiteralInfo GetExactLiterals(const std::string &str) {
+    return {true, str, str, str};
+}
+
+inline const std::string &GetLonger(const std::string &lhs,
+        const std::string &rhs) {
+    return rhs.size() > lhs.size() ? rhs : lhs;
+}
+
+} // namespace
+
+NFAModelPtr REObjectInterface::GenerateNFA() {
     auto model = std::make_shared<NFAModel>();
-    model->set_entry(edge);
-    model->set_tail(node);
-    model->AddSymbol(symbol_);
+    auto fragment = GenerateNFA(*model);
+    model->set_entry(fragment.entry);
+    model->set_tail(fragment.tail);
     return model;
 }
 
-NFAModelPtr REAndObj::GenerateNFA() {
+NFAFragment RENilObj::GenerateNFA(NFAModel &model) {
+    auto node = model.AddNode();
+    auto edge = model.AddEdge(kNFANone, node);
+    return {edge, node};
+}
+
+NFAFragment RESymbolObj::GenerateNFA(NFAModel &model) {
+    auto node = model.AddNode();
+    auto edge = model.AddEdge(model.AddSymbol(symbol_), node);
+    return {edge, node};
+}
+
+bool REObjectInterface::GetLiteralSet(
+        std::vector<std::string> &literals) const {
+    auto info = GetLiterals();
+    if (!info.exact) return false;
+    literals.push_back(info.prefix);
+    return true;
+}
+
+LiteralInfo RENilObj::GetLiterals() const {
+    return GetExactLiterals("");
+}
+
+LiteralInfo RESymbolObj::GetLiterals() const {
+    // check if symbol only accepts one char
+    CharSet char_set;
+    char_set.InsertSymbol(symbol_);
+    if (char_set.Empty()) return GetAnyLiterals();
+    auto c = *char_set.begin();
+    char_set.Remove(c);
+    if (!char_set.Empty()) return GetAnyLiterals();
+    return GetExactLiterals(std::string(1, c));
+}
+
+NFAFragment REAndObj::GenerateNFA(NFAModel &model) {
     // get lhs & rhs
-    auto lhs = lhs_->GenerateNFA();
-    auto rhs = rhs_->GenerateNFA();
-    auto model = std::make_shared<NFAModel>();
-    // set entry & tail
-    model->set_entry(lhs->entry());
-    model->set_tail(rhs->tail());
+    auto lhs = lhs_->GenerateNFA(model);
+    auto rhs = rhs_->GenerateNFA(model);
     // connect lhs & rhs
-    lhs->tail()->AddEdge(rhs->entry());
-    // merge char set
-    model->AddSymbolSet(lhs->symbol_set());
-    model->AddSymbolSet(rhs->symbol_set());
-    return model;
+    model.ConnectEdge(lhs.tail, rhs.entry);
+    return {lhs.entry, rhs.tail};
 }
 
-void REOrObj::PreprocOrLogic(NFAModelPtr model,
-        SymbolPtr common, SymbolPtr symbol) {
+LiteralInfo REAndObj::GetLiterals() const {
+    auto lhs = lhs_->GetLiterals(), rhs = rhs_->GetLiterals();
+    if (lhs.exact && rhs.exact) {
+        return GetExactLiterals(lhs.prefix + rhs.prefix);
+    }
+    LiteralInfo info;
+    info.exact = false;
+    info.prefix = lhs.exact ? lhs.prefix + rhs.prefix : lhs.prefix;
+    info.suffix = rhs.exact ? lhs.suffix + rhs.suffix : rhs.suffix;
+    // literal across the boundary of lhs & rhs
+    auto middle = lhs.suffix + rhs.prefix;
+    info.inner = GetLonger(GetLonger(lhs.inner, rhs.inner), middle);
+    info.inner = GetLonger(GetLonger(info.inner, info.prefix), info.suffix);
+    return info;
+}
+
+void REOrObj::PreprocOrLogic(NFAModel &model, NFAFragment &fragment,
+        const SymbolPtr &common, const SymbolPtr &symbol) {
+    auto common_id = model.AddSymbol(common);
     if (symbol) {
-        auto entry = model->entry();
-        entry->set_symbol(symbol);
+        auto entry = fragment.entry;
+        auto entry_tail = model.edge(entry).tail;
+        model.edge(entry).symbol = model.AddSymbol(symbol);
         // add edge for the common part of symbol
-        auto edge = std::make_shared<NFAEdge>(common, entry->tail());
+        auto edge = model.AddEdge(common_id, entry_tail);
         // add new node for merging two edges
-        auto node = std::make_shared<NFANode>();
-        node->AddEdge(entry);
-        node->AddEdge(edge);
+        auto node = model.AddNode();
+        model.ConnectEdge(node, entry);
+        model.ConnectEdge(node, edge);
         // add & set new entry
-        auto new_entry = std::make_shared<NFAEdge>(nullptr, node);
-        model->set_entry(new_entry);
-        // add symbols
-        model->AddSymbol(common);
-        model->AddSymbol(symbol);
+        fragment.entry = model.AddEdge(kNFANone, node);
     }
     else {
-        model->entry()->set_symbol(common);
-        model->AddSymbol(common);
+        model.edge(fragment.entry).symbol = common_id;
     }
 }
 
-NFAModelPtr REOrObj::GenerateNFA() {
+NFAFragment REOrObj::GenerateNFA(NFAModel &model) {
     // get lhs & rhs
-    auto lhs = lhs_->GenerateNFA();
-    auto rhs = rhs_->GenerateNFA();
+    auto lhs = lhs_->GenerateNFA(model);
+    auto rhs = rhs_->GenerateNFA(model);
     // create charset for two models
     CharSet lhs_set, rhs_set;
-    lhs_set.InsertSymbol(lhs->entry()->symbol());
-    rhs_set.InsertSymbol(rhs->entry()->symbol());
+    lhs_set.InsertSymbol(model.symbol(model.edge(lhs.entry).symbol));
+    rhs_set.InsertSymbol(model.symbol(model.edge(rhs.entry).symbol));
     // judge if charsets have intersections
     if (lhs_set != rhs_set && lhs_set.HasIntersection(rhs_set)) {
         // extract the common part of two sets
@@ -131,48 +191,171 @@ NFAModelPtr REOrObj::GenerateNFA() {
         auto lhs_symbol = lhs_set.MakeSymbol();
         auto rhs_symbol = rhs_set.MakeSymbol();
         // preprocess or logic for lhs & rhs
-        PreprocOrLogic(lhs, common_symbol, lhs_symbol);
-        PreprocOrLogic(rhs, common_symbol, rhs_symbol);
+        PreprocOrLogic(model, lhs, common_symbol, lhs_symbol);
+        PreprocOrLogic(model, rhs, common_symbol, rhs_symbol);
     }
     // create entry edge & state nodes
-    auto node = std::make_shared<NFANode>();
-    auto entry = std::make_shared<NFAEdge>(nullptr, node);
+    auto node = model.AddNode();
+    auto entry = model.AddEdge(kNFANone, node);
     // create tail node & some necessary edges
-    auto tail = std::make_shared<NFANode>();
-    auto back0 = std::make_shared<NFAEdge>(nullptr, tail);
-    auto back1 = std::make_shared<NFAEdge>(nullptr, tail);
+    auto tail = model.AddNode();
+    auto back0 = model.AddEdge(kNFANone, tail);
+    auto back1 = model.AddEdge(kNFANone, tail);
     // generate the 'or' logic
-    node->AddEdge(lhs->entry());
-    node->AddEdge(rhs->entry());
-    lhs->tail()->AddEdge(back0);
-    rhs->tail()->AddEdge(back1);
-    // create the final model
-    auto model = std::make_shared<NFAModel>();
-    model->set_entry(entry);
-    model->set_tail(tail);
-    // merge char set
-    model->AddSymbolSet(lhs->symbol_set());
-    model->AddSymbolSet(rhs->symbol_set());
-    return model;
+    model.ConnectEdge(node, lhs.entry);
+    model.ConnectEdge(node, rhs.entry);
+    model.ConnectEdge(lhs.tail, back0);
+    model.ConnectEdge(rhs.tail, back1);
+    return {entry, tail};
+}
+
+REOrObj::~REOrObj() {
+    // release nested alternations that are only owned by current object
+    // iteratively, so that destroying long chains will not overflow
+    std::vector<REObject> objs;
+    objs.push_back(std::move(lhs_));
+    objs.push_back(std::move(rhs_));
+    while (!objs.empty()) {
+        auto obj = std::move(objs.back());
+        objs.pop_back();
+        if (obj.use_count() != 1) continue;
+        if (auto alt = dynamic_cast<REOrObj *>(obj.get())) {
+            objs.push_back(std::move(alt->lhs_));
+            objs.push_back(std::move(alt->rhs_));
+        }
+    }
+}
+
+LiteralInfo REOrObj::GetLiterals() const {
+    auto lhs = lhs_->GetLiterals(), rhs = rhs_->GetLiterals();
+    if (lhs.exact && rhs.exact && lhs.prefix == rhs.prefix) return lhs;
+    LiteralInfo info;
+    info.exact = false;
+    // get common prefix & common suffix
+    auto prefix = std::mismatch(lhs.prefix.begin(), lhs.prefix.end(),
+            rhs.prefix.begin(), rhs.prefix.end());
+    info.prefix.assign(lhs.prefix.begin(), prefix.first);
+    auto suffix = std::mismatch(lhs.suffix.rbegin(), lhs.suffix.rend(),
+            rhs.suffix.rbegin(), rhs.suffix.rend());
+    info.suffix.assign(suffix.first.base(), lhs.suffix.end());
+    info.inner = GetLonger(info.prefix, info.suffix);
+    return info;
+}
+
+bool REOrObj::GetLiteralSet(std::vector<std::string> &literals) const {
+    // NOTE:  alternations of many literals are deeply nested chains,
+    //        so they are flattened by an explicit stack
+    std::vector<const REObjectInterface *> objs = {this};
+    while (!objs.empty()) {
+        auto obj = objs.back();
+        objs.pop_back();
+        if (auto alt = dynamic_cast<const REOrObj *>(obj)) {
+            // visit 'lhs' first to keep the order of literals
+            objs.push_back(alt->rhs_.get());
+            objs.push_back(alt->lhs_.get());
+        }
+        else if (!obj->GetLiteralSet(literals)) {
+            return false;
+        }
+    }
+    return true;
 }
 
-NFAModelPtr REKleeneObj::GenerateNFA() {
+NFAFragment REKleeneObj::GenerateNFA(NFAModel &model) {
     // create tail node & empty edges
-    auto tail = std::make_shared<NFANode>();
-    auto entry = std::make_shared<NFAEdge>(nullptr, tail);
-    auto back = std::make_shared<NFAEdge>(nullptr, tail);
-    // get source model
-    auto src = reo_->GenerateNFA();
+    auto tail = model.AddNode();
+    auto entry = model.AddEdge(kNFANone, tail);
+    auto back = model.AddEdge(kNFANone, tail);
+    // get source fragment
+    auto src = reo_->GenerateNFA(model);
     // generate kleene closure logic
-    tail->AddEdge(src->entry());
-    src->tail()->AddEdge(back);
-    // generate final model
-    auto model = std::make_shared<NFAModel>();
-    model->set_entry(entry);
-    model->set_tail(tail);
-    // add char set
-    model->AddSymbolSet(src->symbol_set());
-    return model;
+    model.ConnectEdge(tail, src.entry);
+    model.ConnectEdge(src.tail, back);
+    return {entry, tail};
+}
+
+LiteralInfo REKleeneObj::GetLiterals() const {
+    return GetAnyLiterals();
+}
+
+NFAFragment RERepeatObj::GenerateNFA(NFAModel &model) {
+    auto unbounded = max_ == kRepeatInf;
+    auto count = unbounded ? min_ + 1 : max_;
+    if (!count) return RENilObj().GenerateNFA(model);
+    model.AddRepeat(count);
+    // generate the first repetition, and copy the others from it
+    NFAIndex node_begin = model.node_count();
+    NFAIndex edge_begin = model.edge_count();
+    std::vector<NFAFragment> reps = {reo_->GenerateNFA(model)};
+    NFAIndex node_end = model.node_count();
+    NFAIndex edge_end = model.edge_count();
+    reps.reserve(count);
+    while (reps.size() < count) {
+        reps.push_back(model.CopyFragment(reps.front(), node_begin,
+                                          node_end, edge_begin, edge_end));
+    }
+    // required repetitions
+    auto node = model.AddNode();
+    auto entry = model.AddEdge(kNFANone, node);
+    std::size_t i = 0;
+    for (; i < min_; ++i) {
+        model.ConnectEdge(node, reps[i].entry);
+        node = reps[i].tail;
+    }
+    if (unbounded) {
+        // kleene closure of the last repetition
+        auto tail = model.AddNode();
+        model.ConnectEdge(node, model.AddEdge(kNFANone, tail));
+        model.ConnectEdge(tail, reps[i].entry);
+        model.ConnectEdge(reps[i].tail, model.AddEdge(kNFANone, tail));
+        return {entry, tail};
+    }
+    // optional repetitions are nested ('x(x(x)?)?'), so that
+    // each repetition can skip to tail directly
+    auto tail = model.AddNode();
+    for (; i < count; ++i) {
+        model.ConnectEdge(node, reps[i].entry);
+        model.ConnectEdge(node, model.AddEdge(kNFANone, tail));
+        node = reps[i].tail;
+    }
+    model.ConnectEdge(node, model.AddEdge(kNFANone, tail));
+    return {entry, tail};
+}
+
+LiteralInfo RERepeatObj::GetLiterals() const {
+    if (!max_) return GetExactLiterals("");
+    if (!min_) return GetAnyLiterals();
+    auto info = reo_->GetLiterals();
+    if (info.exact) {
+        std::string literal;
+        for (std::size_t i = 0; i < min_; ++i) literal += info.prefix;
+        if (min_ == max_) return GetExactLiterals(literal);
+        return {false, literal, literal, literal};
+    }
+    // literal across the boundary of two repetitions
+    if (min_ > 1) {
+        info.inner = GetLonger(info.inner, info.suffix + info.prefix);
+    }
+    return info;
+}
+
+NFAFragment RECaptureObj::GenerateNFA(NFAModel &model) {
+    // tag 'group * 2' marks the start of submatch,
+    // and tag 'group * 2 + 1' marks the end of submatch
+    auto src = reo_->GenerateNFA(model);
+    auto node = model.AddNode();
+    model.ConnectEdge(node, src.entry);
+    auto entry = model.AddEdge(kNFANone, node);
+    model.SetTag(entry, group_ * 2);
+    auto tail = model.AddNode();
+    auto back = model.AddEdge(kNFANone, tail);
+    model.SetTag(back, group_ * 2 + 1);
+    model.ConnectEdge(src.tail, back);
+    return {entry, tail};
+}
+
+LiteralInfo RECaptureObj::GetLiterals() const {
+    return reo_->GetLiterals();
 }
 
 } // namespace rex::re
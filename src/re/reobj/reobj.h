@@ -2,6 +2,7 @@
 #define REX_RE_REOBJ_REOBJ_H_
 
 #include <string>
+#include <vector>
 #include <utility>
 #include <functional>
 
@@ -11,6 +12,9 @@ namespace rex::re {
 
 class REObject;
 
+// upper bound of unbounded repetitions
+constexpr std::size_t kRepeatInf = ~static_cast<std::size_t>(0);
+
 // helper functions
 REObject Nil();
 REObject Word(const std::string &word);
@@ -21,11 +25,33 @@ REObject Or(REObject lhs, REObject rhs);
 REObject Many(REObject reo);
 REObject Many1(REObject reo);
 REObject Optional(REObject reo);
+// repeat 'reo' at least 'min' times & at most 'max' times,
+// 'max' can be 'kRepeatInf' for unbounded repetitions
+REObject Repeat(REObject reo, std::size_t min, std::size_t max);
+// mark the submatch of 'reo' as capture group, group 0 is reserved
+// for the whole match
+REObject Capture(REObject reo, std::size_t group);
+
+// literals that are required by all strings matched by an object
+struct LiteralInfo {
+    // all matched strings are exactly 'prefix'
+    bool exact;
+    // required prefix & suffix, and the longest required literal
+    std::string prefix, suffix, inner;
+};
 
 class REObjectInterface {
 public:
     virtual ~REObjectInterface() = default;
-    virtual NFAModelPtr GenerateNFA() = 0;
+    // generate a new NFA model
+    NFAModelPtr GenerateNFA();
+    // generate NFA fragment in the arena of an existing NFA model
+    virtual NFAFragment GenerateNFA(NFAModel &model) = 0;
+    // get the required literals of current object
+    virtual LiteralInfo GetLiterals() const = 0;
+    // append all strings matched by current object to 'literals',
+    // returns false if current object is not an alternation of literals
+    virtual bool GetLiteralSet(std::vector<std::string> &literals) const;
 };
 
 class REObject : public std::shared_ptr<REObjectInterface> {
@@ -54,20 +80,30 @@ public:
     REObject Optional() {
         return rex::re::Optional(*this);
     }
+
+    REObject Repeat(std::size_t min, std::size_t max) {
+        return rex::re::Repeat(*this, min, max);
+    }
+
+    REObject Capture(std::size_t group) {
+        return rex::re::Capture(*this, group);
+    }
 };
 
 class RENilObj : public REObjectInterface {
 public:
     RENilObj() {}
 
-    NFAModelPtr GenerateNFA() override;
+    NFAFragment GenerateNFA(NFAModel &model) override;
+    LiteralInfo GetLiterals() const override;
 };
 
 class RESymbolObj : public REObjectInterface {
 public:
     RESymbolObj(const SymbolPtr &symbol) : symbol_(symbol) {}
 
-    NFAModelPtr GenerateNFA() override;
+    NFAFragment GenerateNFA(NFAModel &model) override;
+    LiteralInfo GetLiterals() const override;
 
 private:
     SymbolPtr symbol_;
@@ -78,7 +114,8 @@ public:
     REAndObj(REObject lhs, REObject rhs)
             : lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
 
-    NFAModelPtr GenerateNFA() override;
+    NFAFragment GenerateNFA(NFAModel &model) override;
+    LiteralInfo GetLiterals() const override;
 
 private:
     REObject lhs_, rhs_;
@@ -88,11 +125,15 @@ class REOrObj : public REObjectInterface {
 public:
     REOrObj(REObject lhs, REObject rhs)
             : lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
+    ~REOrObj();
 
-    NFAModelPtr GenerateNFA() override;
+    NFAFragment GenerateNFA(NFAModel &model) override;
+    LiteralInfo GetLiterals() const override;
+    bool GetLiteralSet(std::vector<std::string> &literals) const override;
 
 private:
-    void PreprocOrLogic( NFAModelPtr,  SymbolPtr,  SymbolPtr);
+    void PreprocOrLogic(NFAModel &model, NFAFragment &fragment,
+            const SymbolPtr &common, const SymbolPtr &symbol);
 
     REObject lhs_, rhs_;
 };
@@ -101,10 +142,45 @@ class REKleeneObj : public REObjectInterface {
 public:
     REKleeneObj(REObject reo) : reo_(std::move(reo)) {}
 
-    NFAModelPtr GenerateNFA() override;
+    NFAFragment GenerateNFA(NFAModel &model) override;
+    LiteralInfo GetLiterals() const override;
+
+private:
+    REObject reo_;
+};
+
+// NOTE:  sub-NFA of repeated object is generated only once,
+//        and the other repetitions are copied from it
+// NOTE:  repetitions are not counted, NFA grows linearly with 'max'
+//        (or 'min' if unbounded), and DFA states may multiply with it
+//        (e.g. '[ab]*a[ab]{1,1000}'), so 'Regex' with 'Auto' engine
+//        matches patterns with more than 'Regex::kMaxDFARepeat' copies
+//        by NFA, but the explicit DFA engine, 'Lexer' and 'Searcher'
+//        always build DFA
+class RERepeatObj : public REObjectInterface {
+public:
+    RERepeatObj(REObject reo, std::size_t min, std::size_t max)
+            : reo_(std::move(reo)), min_(min), max_(max) {}
+
+    NFAFragment GenerateNFA(NFAModel &model) override;
+    LiteralInfo GetLiterals() const override;
+
+private:
+    REObject reo_;
+    std::size_t min_, max_;
+};
+
+class RECaptureObj : public REObjectInterface {
+public:
+    RECaptureObj(REObject reo, std::size_t group)
+            : reo_(std::move(reo)), group_(group) {}
+
+    NFAFragment GenerateNFA(NFAModel &model) override;
+    LiteralInfo GetLiterals() const override;
 
 private:
     REObject reo_;
+    std::size_t group_;
 };
 
 } // namespace rex::re
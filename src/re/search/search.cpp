@@ -0,0 +1,322 @@
+#include <re/search/search.h>
+
+#include <deque>
+#include <algorithm>
+
+namespace {
+
+using namespace rex::re;
+
+constexpr auto npos = std::string_view::npos;
+
+// a start of match in forward scan, which is waiting for its end
+// NOTE:  if threads of two starts reach the same state, the earlier
+//        one is merged into the later one, and all accepts after the
+//        merge position are shared, so the end of merged start is the
+//        end of the later one if it is after the merge position,
+//        otherwise it is the end of the last accept before merging
+struct PendingStart {
+    // position of start, end of the last accept ('npos' if none)
+    std::size_t pos, last;
+    // id of the later start & merge position, 'npos' if not merged
+    std::size_t next, merged_at;
+    // thread of start is dead, available if not merged
+    bool dead;
+};
+
+// thread of forward scan, 'id' is the id of its start
+struct ScanThread {
+    StateTable::StateId state;
+    std::size_t id;
+};
+
+rex::re::StateTablePtr GenerateTable(const rex::re::NFAModelPtr &nfa) {
+    auto dfa = nfa->GenerateDFA();
+    dfa->Simplify();
+    return dfa->GenerateStateTable();
+}
+
+} // namespace
+
+namespace rex::re {
+
+Searcher::Searcher(const REObject &reo) {
+    // alternation of literals
+    std::vector<std::string> literal_set;
+    if (reo->GetLiteralSet(literal_set) && literal_set.size() > 1) {
+        multi_ = MakeMultiLiteral(literal_set);
+        if (multi_) return;
+    }
+    forward_ = GenerateTable(reo->GenerateNFA());
+    // add '.*' prefix to find the end of matches
+    auto prefix = reo->GenerateNFA();
+    prefix->MakeUnanchored();
+    prefix_ = GenerateTable(prefix);
+    // scan backward with reversed pattern to find the start of matches
+    auto nfa = reo->GenerateNFA();
+    nfa->NormalizeNFA();
+    auto reverse = nfa->GenerateReverse();
+    reverse->MakeUnanchored();
+    reverse_ = GenerateTable(reverse);
+    // get literals for prefiltering
+    auto literals = reo->GetLiterals();
+    prefix_lit_ = LiteralFinder(literals.prefix);
+    if (literals.inner.size() > literals.prefix.size()) {
+        required_lit_ = LiteralFinder(literals.inner);
+    }
+}
+
+std::size_t Searcher::FindFirstEnd(std::string_view text,
+        std::size_t pos) const {
+    auto state = prefix_->initial();
+    if (prefix_->IsAccept(state)) return pos;
+    for (auto i = pos; i < text.size(); ++i) {
+        state = prefix_->Next(state, text[i]);
+        if (prefix_->IsAccept(state)) return i + 1;
+    }
+    return npos;
+}
+
+std::size_t Searcher::FindLongestEnd(std::string_view text,
+        std::size_t pos, std::size_t &stop) const {
+    auto state = forward_->initial();
+    auto end = forward_->IsAccept(state) ? pos : npos;
+    for (stop = pos; stop < text.size(); ++stop) {
+        state = forward_->Next(state, text[stop]);
+        if (forward_->IsDead(state)) break;
+        if (forward_->IsAccept(state)) end = stop + 1;
+    }
+    return end;
+}
+
+void Searcher::MarkStarts(std::string_view text,
+        std::vector<bool> &starts) const {
+    starts.assign(text.size() + 1, false);
+    auto state = reverse_->initial();
+    starts[text.size()] = reverse_->IsAccept(state);
+    for (auto i = text.size(); i > 0; --i) {
+        state = reverse_->Next(state, text[i - 1]);
+        starts[i - 1] = reverse_->IsAccept(state);
+    }
+}
+
+template <typename IsStart, typename Handler>
+void Searcher::ScanMatches(std::string_view text, std::size_t pos,
+        std::size_t limit, IsStart is_start, Handler handler) const {
+    const auto &table = *forward_;
+    // pending starts in the order of position, indexed by 'id - base'
+    std::deque<PendingStart> starts;
+    std::size_t base = 0, cur = npos;
+    std::vector<ScanThread> threads, next_threads;
+    std::vector<std::size_t> slots(table.state_count(), npos), chain;
+    auto get = [&starts, &base](std::size_t id) -> PendingStart & {
+        return starts[id - base];
+    };
+    // get the end of start's longest match, returns false if unknown
+    auto resolve = [&](std::size_t id, std::size_t &end) {
+        // find the last start in merge chain, and compress the chain
+        chain.clear();
+        auto root = id;
+        for (; get(root).next != npos; root = get(root).next) {
+            chain.push_back(root);
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            auto &start = get(*it);
+            if (start.next == root) continue;
+            const auto &next = get(start.next);
+            if (next.last != npos && next.last > start.merged_at) {
+                start.last = next.last;
+            }
+            start.merged_at = next.merged_at;
+            start.next = root;
+        }
+        if (!get(root).dead) return false;
+        const auto &start = get(id);
+        end = start.last;
+        if (id != root) {
+            auto last = get(root).last;
+            if (last != npos && last > start.merged_at) end = last;
+        }
+        return true;
+    };
+    auto add_start = [&](std::size_t i) {
+        auto id = base + starts.size();
+        auto state = table.initial();
+        auto last = table.IsAccept(state) ? i : npos;
+        starts.push_back({i, last, npos, 0, false});
+        if (cur == npos) cur = id;
+        for (auto &&thread : threads) {
+            if (thread.state != state) continue;
+            get(thread.id).next = id;
+            get(thread.id).merged_at = i;
+            thread.id = id;
+            return;
+        }
+        threads.push_back({state, id});
+    };
+    // report resolved starts in order, returns false if stopped
+    auto report = [&] {
+        std::size_t end;
+        while (cur != npos && resolve(cur, end)) {
+            auto start = get(cur).pos;
+            auto next_pos = start + 1;
+            if (end != npos) {
+                if (!handler(Match{start, end - start})) return false;
+                // empty match can not be repeated
+                pos = std::max(end, next_pos);
+                next_pos = pos;
+            }
+            // drop starts that can not be reported
+            while (!starts.empty() && starts.front().pos < next_pos) {
+                starts.pop_front();
+                ++base;
+            }
+            cur = starts.empty() ? npos : base;
+            threads.erase(std::remove_if(threads.begin(), threads.end(),
+                    [base](const ScanThread &t) { return t.id < base; }),
+                    threads.end());
+        }
+        return true;
+    };
+    for (auto i = pos;;) {
+        if (i >= pos && i <= limit && is_start(i)) add_start(i);
+        if (i == text.size()) {
+            for (const auto &thread : threads) get(thread.id).dead = true;
+            threads.clear();
+        }
+        if (!report() || i == text.size()) return;
+        if (threads.empty()) {
+            // skip to the next start
+            i = std::max(i + 1, pos);
+            while (i <= limit && !is_start(i)) ++i;
+            if (i > limit) return;
+            continue;
+        }
+        // step all threads, and merge threads with the same state
+        next_threads.clear();
+        for (const auto &thread : threads) {
+            auto state = table.Next(thread.state, text[i]);
+            auto &start = get(thread.id);
+            if (table.IsDead(state)) {
+                start.dead = true;
+                continue;
+            }
+            if (table.IsAccept(state)) start.last = i + 1;
+            auto &slot = slots[table.GetStateIndex(state)];
+            if (slot == npos) {
+                slot = next_threads.size();
+                next_threads.push_back({state, thread.id});
+                continue;
+            }
+            auto &other = next_threads[slot];
+            auto older = std::min(other.id, thread.id);
+            get(older).next = std::max(other.id, thread.id);
+            get(older).merged_at = i + 1;
+            other.id = get(older).next;
+        }
+        for (const auto &thread : next_threads) {
+            slots[table.GetStateIndex(thread.state)] = npos;
+        }
+        threads.swap(next_threads);
+        ++i;
+    }
+}
+
+template <typename Handler>
+void Searcher::ForEachMatch(std::string_view text, Handler handler) const {
+    if (multi_) {
+        std::size_t start, len;
+        for (std::size_t pos = 0; multi_->Find(text, pos, start, len);
+                pos = start + len) {
+            handler(Match{start, len});
+        }
+        return;
+    }
+    if (!required_lit_.empty() && !required_lit_.Test(text)) return;
+    std::size_t pos = 0;
+    if (!prefix_lit_.empty()) {
+        // try the occurrences of prefix literal only, and fall back
+        // when anchored scans have visited more bytes than the text
+        auto budget = text.size();
+        auto cand = prefix_lit_.Find(text);
+        for (; cand != npos; cand = prefix_lit_.Find(text, pos)) {
+            std::size_t stop;
+            auto end = FindLongestEnd(text, cand, stop);
+            if (end != npos) {
+                handler(Match{cand, end - cand});
+                pos = end;
+            }
+            else {
+                pos = cand + 1;
+            }
+            if (stop - cand > budget) break;
+            budget -= stop - cand;
+        }
+        if (cand == npos) return;
+    }
+    if (FindFirstEnd(text, pos) == npos) return;
+    std::vector<bool> starts;
+    MarkStarts(text, starts);
+    ScanMatches(text, pos, text.size(),
+            [&starts](std::size_t i) { return starts[i]; },
+            [&handler](const Match &match) {
+                handler(match);
+                return true;
+            });
+}
+
+bool Searcher::Find(std::string_view text, Match &match,
+        std::size_t pos) const {
+    if (pos > text.size()) return false;
+    if (multi_) {
+        return multi_->Find(text, pos, match.pos, match.len);
+    }
+    if (!required_lit_.empty() &&
+            required_lit_.Find(text, pos) == npos) {
+        return false;
+    }
+    if (!prefix_lit_.empty()) {
+        // all matches start with prefix literal
+        auto budget = text.size() - pos;
+        auto cand = prefix_lit_.Find(text, pos);
+        for (; cand != npos; cand = prefix_lit_.Find(text, cand + 1)) {
+            std::size_t stop;
+            auto end = FindLongestEnd(text, cand, stop);
+            if (end != npos) {
+                match = {cand, end - cand};
+                return true;
+            }
+            if (stop - cand > budget) break;
+            budget -= stop - cand;
+        }
+        if (cand == npos) return false;
+        pos = cand + 1;
+    }
+    // make sure there is at least one match
+    auto first_end = FindFirstEnd(text, pos);
+    if (first_end == npos) return false;
+    // the leftmost match starts at or before the earliest end,
+    // so try all positions before it, and stop at the first match
+    ScanMatches(text, pos, first_end, [](std::size_t) { return true; },
+            [&match](const Match &m) {
+                match = m;
+                return false;
+            });
+    return true;
+}
+
+std::vector<Match> Searcher::FindAll(std::string_view text) const {
+    std::vector<Match> matches;
+    ForEachMatch(text, [&matches](const Match &match) {
+        matches.push_back(match);
+    });
+    return matches;
+}
+
+std::size_t Searcher::Count(std::string_view text) const {
+    std::size_t count = 0;
+    ForEachMatch(text, [&count](const Match &) { ++count; });
+    return count;
+}
+
+} // namespace rex::re
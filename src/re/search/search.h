@@ -0,0 +1,84 @@
+#ifndef REX_RE_SEARCH_SEARCH_H_
+#define REX_RE_SEARCH_SEARCH_H_
+
+#include <memory>
+#include <vector>
+#include <string_view>
+#include <cstddef>
+
+#include <re/reobj/reobj.h>
+#include <re/util/table.h>
+#include <re/util/literal.h>
+#include <re/multi/multi.h>
+
+namespace rex::re {
+
+class Searcher;
+
+using SearcherPtr = std::shared_ptr<Searcher>;
+
+// position & length of a match in text
+struct Match {
+    std::size_t pos, len;
+};
+
+// unanchored search, finds the leftmost-longest matches in text
+// NOTE:  'FindAll' & 'Count' mark match starts by a backward scan,
+//        then extend all marked starts in a single forward scan,
+//        threads of starts that reach the same DFA state are merged,
+//        so the scan takes O(n * m) time in the worst case (m is the
+//        count of DFA states), and usually O(n) time
+// NOTE:  'Find' does not keep anything between calls, each call may
+//        scan to the end of text in the worst case, so use 'FindAll'
+//        or 'Count' instead of calling 'Find' in a loop
+// NOTE:  literals required by pattern are searched first, texts that
+//        do not contain them are rejected without running the DFA,
+//        and if all matches start with a literal, only its occurrences
+//        are tried as match starts (until it stops paying off)
+// NOTE:  alternations of literals are matched by multi-literal engine
+//        directly, without building any automaton from NFA
+class Searcher {
+public:
+    Searcher(const REObject &reo);
+    ~Searcher() {}
+
+    // find the first match that starts at or after 'pos'
+    bool Find(std::string_view text, Match &match,
+            std::size_t pos = 0) const;
+    // find all non-overlapping matches
+    std::vector<Match> FindAll(std::string_view text) const;
+    // count all non-overlapping matches
+    std::size_t Count(std::string_view text) const;
+
+private:
+    // get the end of the earliest match, or 'npos' if not found
+    std::size_t FindFirstEnd(std::string_view text, std::size_t pos) const;
+    // get the end of the longest match starting at 'pos', or 'npos',
+    // 'stop' will be set to where the scan stopped
+    std::size_t FindLongestEnd(std::string_view text, std::size_t pos,
+            std::size_t &stop) const;
+    // mark all positions in text where a match starts
+    void MarkStarts(std::string_view text, std::vector<bool> &starts) const;
+    // scan forward from 'pos' and call 'handler' with non-overlapping
+    // matches, only starts that not greater than 'limit' & accepted by
+    // 'is_start' are tried, stops if 'handler' returns false
+    template <typename IsStart, typename Handler>
+    void ScanMatches(std::string_view text, std::size_t pos,
+            std::size_t limit, IsStart is_start, Handler handler) const;
+    // call 'handler' with all non-overlapping matches
+    template <typename Handler>
+    void ForEachMatch(std::string_view text, Handler handler) const;
+
+    // DFA of pattern, pattern with '.*' prefix,
+    // and reversed pattern with '.*' prefix
+    StateTablePtr forward_, prefix_, reverse_;
+    // literal that all matches start with,
+    // and the longest literal that all matches contain
+    LiteralFinder prefix_lit_, required_lit_;
+    // matcher of literal set, if pattern is an alternation of literals
+    MultiLiteral multi_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_SEARCH_SEARCH_H_
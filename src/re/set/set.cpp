@@ -0,0 +1,170 @@
+#include <re/set/set.h>
+
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+
+#include <re/nfa/subset.h>
+
+namespace rex::re {
+
+RegexSet::RegexSet(const std::vector<REObject> &patterns, bool anchored,
+        std::size_t max_states)
+        : size_(patterns.size()), anchored_(anchored),
+          max_states_(max_states) {
+    if (!patterns.empty()) BuildPartitions(patterns, 0, patterns.size());
+}
+
+void RegexSet::BuildPartitions(const std::vector<REObject> &patterns,
+        std::size_t begin, std::size_t end) {
+    Partition part;
+    part.first_id = begin;
+    if (BuildDFA(patterns, part, end)) {
+        partitions_.push_back(std::move(part));
+        return;
+    }
+    // split patterns into two halves
+    if (end - begin > 1) {
+        auto mid = begin + (end - begin) / 2;
+        BuildPartitions(patterns, begin, mid);
+        BuildPartitions(patterns, mid, end);
+        return;
+    }
+    // DFA of a single pattern is too large
+    decltype(part.offsets)().swap(part.offsets);
+    decltype(part.ids)().swap(part.ids);
+    if (anchored_) {
+        part.regex = std::make_shared<Regex>(patterns[begin]);
+    }
+    else {
+        part.searcher = std::make_shared<Searcher>(patterns[begin]);
+    }
+    partitions_.push_back(std::move(part));
+}
+
+bool RegexSet::BuildDFA(const std::vector<REObject> &patterns,
+        Partition &part, std::size_t end) const {
+    // connect all patterns to the same entry node,
+    // final nodes carry the relative indices of patterns
+    NFAModel nfa;
+    auto node = nfa.AddNode();
+    auto entry = nfa.AddEdge(kNFANone, node);
+    for (auto i = part.first_id; i < end; ++i) {
+        auto fragment = patterns[i]->GenerateNFA(nfa);
+        nfa.ConnectEdge(node, fragment.entry);
+        nfa.AddFinalNode(fragment.tail, i - part.first_id);
+    }
+    nfa.set_entry(entry);
+    nfa.set_tail(node);
+    if (!anchored_) nfa.MakeUnanchored();
+    // token of DFA state is the index of its set of matched patterns,
+    // which contains the tokens of all final nodes in state
+    std::unordered_map<NodeList, int, NodeListHash> set_ids;
+    NodeList ids;
+    part.offsets.assign(1, 0);
+    part.ids.clear();
+    auto get_token = [&](const std::vector<NFAIndex> &nodes) {
+        ids.clear();
+        for (const auto &i : nodes) {
+            if (nfa.token(i) >= 0) ids.push_back(nfa.token(i));
+        }
+        if (ids.empty()) return -1;
+        std::sort(ids.begin(), ids.end());
+        auto ret = set_ids.insert({ids, part.offsets.size() - 1});
+        if (ret.second) {
+            part.ids.insert(part.ids.end(), ids.begin(), ids.end());
+            part.offsets.push_back(part.ids.size());
+        }
+        return ret.first->second;
+    };
+    auto dfa = nfa.GenerateDFA(max_states_, get_token);
+    if (!dfa) return false;
+    dfa->Simplify();
+    part.table = dfa->GenerateStateTable();
+    return true;
+}
+
+template <typename Handler>
+void RegexSet::MatchPartition(const Partition &part, std::string_view str,
+        Handler handler) const {
+    // fallback engines
+    if (part.regex) {
+        if (part.regex->TestString(str.data(), str.size())) {
+            handler(part.first_id);
+        }
+        return;
+    }
+    if (part.searcher) {
+        rex::re::Match match;
+        if (part.searcher->Find(str, match)) handler(part.first_id);
+        return;
+    }
+    // report matched patterns of set
+    auto report = [&part, &handler](std::size_t set) {
+        for (auto i = part.offsets[set]; i < part.offsets[set + 1]; ++i) {
+            if (!handler(part.first_id + part.ids[i])) return false;
+        }
+        return true;
+    };
+    const auto &table = *part.table;
+    if (anchored_) {
+        auto state = table.Run(table.initial(), str.data(), str.size());
+        if (state && table.IsAccept(state)) report(table.GetToken(state));
+        return;
+    }
+    // patterns match if any state that accepts them is reached,
+    // each set is reported only once, sets that have been reported
+    // are marked by the current epoch, so marks are never cleared
+    // NOTE:  marks are reused by all calls in the same thread
+    thread_local std::vector<std::uint32_t> marks;
+    thread_local std::uint32_t epoch = 0;
+    auto set_count = part.offsets.size() - 1;
+    if (marks.size() < set_count) marks.resize(set_count, 0);
+    if (!++epoch) {
+        std::fill(marks.begin(), marks.end(), 0);
+        epoch = 1;
+    }
+    auto visit = [&](StateTable::StateId state) {
+        if (!table.IsAccept(state)) return true;
+        auto set = table.GetToken(state);
+        if (marks[set] == epoch) return true;
+        marks[set] = epoch;
+        return report(set);
+    };
+    auto state = table.initial();
+    if (!visit(state)) return;
+    for (const auto &c : str) {
+        state = table.Next(state, c);
+        if (!state) return;
+        if (!visit(state)) return;
+    }
+}
+
+bool RegexSet::Match(std::string_view str,
+        std::vector<std::size_t> &ids) const {
+    ids.clear();
+    for (const auto &part : partitions_) {
+        MatchPartition(part, str, [&ids](std::size_t id) {
+            ids.push_back(id);
+            return true;
+        });
+    }
+    // patterns may be reported by multiple states
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return !ids.empty();
+}
+
+bool RegexSet::IsMatch(std::string_view str) const {
+    bool matched = false;
+    for (const auto &part : partitions_) {
+        MatchPartition(part, str, [&matched](std::size_t) {
+            matched = true;
+            return false;
+        });
+        if (matched) return true;
+    }
+    return false;
+}
+
+} // namespace rex::re
@@ -0,0 +1,87 @@
+#ifndef REX_RE_SET_SET_H_
+#define REX_RE_SET_SET_H_
+
+#include <memory>
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/reobj/reobj.h>
+#include <re/regex/regex.h>
+#include <re/search/search.h>
+
+namespace rex::re {
+
+class RegexSet;
+
+using RegexSetPtr = std::shared_ptr<RegexSet>;
+
+// set of patterns that are matched together by scanning input once,
+// reports the indices of all matched patterns
+// NOTE:  all patterns are combined into a product DFA, the token of
+//        each final state is the index of the set of patterns that
+//        accept there,
+//        if the DFA gets too large, patterns will be split into
+//        partitions, each partition has its own DFA, and a pattern
+//        whose own DFA is too large will be matched by 'Regex' or
+//        'Searcher' independently
+class RegexSet {
+public:
+    // partitions with more DFA states will be split
+    static constexpr std::size_t kMaxStates = 10000;
+
+    // if 'anchored' is true, a pattern matches if it matches the whole
+    // input, otherwise it matches if it matches any substring of input
+    RegexSet(const std::vector<REObject> &patterns, bool anchored = true,
+            std::size_t max_states = kMaxStates);
+    ~RegexSet() {}
+
+    // get the indices of all matched patterns in ascending order,
+    // returns false if no pattern matches
+    bool Match(std::string_view str, std::vector<std::size_t> &ids) const;
+    // check if any pattern matches
+    bool IsMatch(std::string_view str) const;
+
+    // count of patterns
+    std::size_t size() const { return size_; }
+    bool anchored() const { return anchored_; }
+    // count of partitions, 1 if all patterns are in the same DFA
+    std::size_t partition_count() const { return partitions_.size(); }
+
+private:
+    // patterns matched by one DFA, or a fallback engine
+    struct Partition {
+        // index of the first pattern in partition
+        std::size_t first_id;
+        // minimized DFA of all patterns in partition
+        StateTablePtr table;
+        // sets of matched patterns (relative to 'first_id'),
+        // set 'i' is 'ids[offsets[i]]' to 'ids[offsets[i + 1]]'
+        std::vector<std::uint32_t> offsets, ids;
+        // fallback engines of a single pattern
+        RegexPtr regex;
+        SearcherPtr searcher;
+    };
+
+    // build partitions for patterns in range '[begin, end)'
+    void BuildPartitions(const std::vector<REObject> &patterns,
+            std::size_t begin, std::size_t end);
+    // build DFA of partition, returns false if DFA is too large
+    bool BuildDFA(const std::vector<REObject> &patterns,
+            Partition &part, std::size_t end) const;
+    // match partition, calls 'handler' with each matched index,
+    // stops matching if 'handler' returns false
+    template <typename Handler>
+    void MatchPartition(const Partition &part, std::string_view str,
+            Handler handler) const;
+
+    std::size_t size_;
+    bool anchored_;
+    std::size_t max_states_;
+    std::vector<Partition> partitions_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_SET_SET_H_
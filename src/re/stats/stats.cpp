@@ -0,0 +1,64 @@
+#include <re/stats/stats.h>
+
+#include <algorithm>
+
+namespace {
+
+using namespace rex::re;
+
+// estimated size of a node of hash table or list
+constexpr std::size_t kNodeOverhead = 2 * sizeof(void *);
+
+// NFA, DFA & state table may be alive at the same time
+void UpdatePeak(CompileStats *stats) {
+    auto bytes = stats->nfa_bytes + stats->dfa_bytes + stats->table_bytes;
+    stats->structural_peak_bytes = std::max(stats->structural_peak_bytes,
+                                            bytes);
+}
+
+} // namespace
+
+namespace rex::re {
+
+void RecordNFA(CompileStats *stats, const NFAModel &nfa) {
+    if (!stats) return;
+    stats->nfa_nodes = nfa.node_count();
+    stats->nfa_edges = nfa.edge_count();
+    stats->nfa_symbols = nfa.symbol_count();
+    // nodes, edges, compact arcs & symbol table
+    stats->nfa_bytes = nfa.node_count() * (sizeof(NFANode) +
+                                           sizeof(NFAIndex) + sizeof(int)) +
+                       nfa.edge_count() * (sizeof(NFAEdge) + sizeof(NFAArc)) +
+                       nfa.symbol_count() * (sizeof(SymbolPtr) * 2 +
+                                             kNodeOverhead);
+    UpdatePeak(stats);
+}
+
+void RecordDFA(CompileStats *stats, const DFAModel &dfa, bool minimized) {
+    if (!stats) return;
+    (minimized ? stats->min_dfa_states : stats->dfa_states) =
+            dfa.state_count();
+    stats->dfa_edges = dfa.edge_count();
+    stats->class_count = dfa.char_class().class_count();
+    // states & edges are held by shared pointers
+    stats->dfa_bytes = dfa.state_count() * (sizeof(DFAState) +
+                                            sizeof(DFAStatePtr) +
+                                            2 * kNodeOverhead) +
+                       dfa.edge_count() * (sizeof(DFAEdge) +
+                                           sizeof(DFAEdgePtr) +
+                                           2 * kNodeOverhead);
+    UpdatePeak(stats);
+}
+
+void RecordTable(CompileStats *stats, const StateTable &table) {
+    if (!stats) return;
+    auto state_count = table.state_count();
+    stats->class_count = table.class_count();
+    stats->table_bytes = (state_count << table.shift()) *
+                         sizeof(StateTable::StateId) + 256 +
+                         (state_count + 63) / 64 * sizeof(std::uint64_t) +
+                         state_count * sizeof(std::int32_t);
+    UpdatePeak(stats);
+}
+
+} // namespace rex::re
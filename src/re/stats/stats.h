@@ -0,0 +1,69 @@
+#ifndef REX_RE_STATS_STATS_H_
+#define REX_RE_STATS_STATS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <re/nfa/nfa.h>
+#include <re/dfa/dfa.h>
+#include <re/util/table.h>
+
+namespace rex::re {
+
+// statistics of compilation pipeline, only collected if a pointer
+// to it is passed to compile APIs (e.g. 'Regex' & 'Lexer::Build')
+// NOTE:  memory usages are structural estimates, which are computed
+//        from the counts & element sizes of data structures, neither
+//        allocator overhead nor temporary buffers are included
+struct CompileStats {
+    // wall time of each phase in nanoseconds
+    std::uint64_t nfa_time = 0, normalize_time = 0, dfa_time = 0;
+    std::uint64_t simplify_time = 0, build_time = 0;
+    // size of NFA
+    std::size_t nfa_nodes = 0, nfa_edges = 0, nfa_symbols = 0;
+    // DFA states before & after minimization, and count of char classes
+    std::size_t dfa_states = 0, min_dfa_states = 0, dfa_edges = 0;
+    std::size_t class_count = 0;
+    // estimated size of each structure, and the largest sum of them
+    // during compilation, which is not the peak of actual allocation
+    std::size_t nfa_bytes = 0, dfa_bytes = 0, table_bytes = 0;
+    std::size_t structural_peak_bytes = 0;
+
+    std::uint64_t total_time() const {
+        return nfa_time + normalize_time + dfa_time + simplify_time +
+               build_time;
+    }
+};
+
+// measures the wall time of a phase until it is destructed,
+// does nothing if 'stats' is null
+class PhaseTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PhaseTimer(CompileStats *stats, std::uint64_t CompileStats::*time)
+            : stats_(stats), time_(time) {
+        if (stats_) begin_ = Clock::now();
+    }
+    ~PhaseTimer() {
+        if (!stats_) return;
+        auto elapsed = Clock::now() - begin_;
+        stats_->*time_ += std::chrono::duration_cast<
+                std::chrono::nanoseconds>(elapsed).count();
+    }
+
+private:
+    CompileStats *stats_;
+    std::uint64_t CompileStats::*time_;
+    Clock::time_point begin_;
+};
+
+// record sizes of models, do nothing if 'stats' is null
+void RecordNFA(CompileStats *stats, const NFAModel &nfa);
+void RecordDFA(CompileStats *stats, const DFAModel &dfa, bool minimized);
+void RecordTable(CompileStats *stats, const StateTable &table);
+
+} // namespace rex::re
+
+#endif // REX_RE_STATS_STATS_H_
@@ -0,0 +1,76 @@
+#include <re/stream/stream.h>
+
+#include <cassert>
+
+namespace rex::re {
+
+void TokenStream::Reset() {
+    assert(lexer_->table());
+    pending_.clear();
+    base_ = pos_ = size_ = 0;
+    last_rule_ = -1;
+    last_end_ = 0;
+    state_ = lexer_->table()->initial();
+}
+
+void TokenStream::Feed(const char *data, std::size_t len,
+        std::vector<Token> &tokens) {
+    Scan(data, len, false, tokens);
+    size_ += len;
+}
+
+void TokenStream::Scan(const char *data, std::size_t len, bool eof,
+        std::vector<Token> &tokens) {
+    const auto &table = *lexer_->table();
+    // NOTE:  bytes before 'chunk_base' are stored in pending buffer
+    auto chunk_base = size_, chunk_end = size_ + len;
+    auto state = state_;
+    for (;;) {
+        if (pos_ == chunk_end) {
+            // wait for the next chunk
+            if (!eof || base_ == chunk_end) break;
+        }
+        else {
+            auto c = pos_ < chunk_base ? pending_[pos_ - base_]
+                                       : data[pos_ - chunk_base];
+            state = table.Next(state, c);
+            if (!table.IsDead(state)) {
+                ++pos_;
+                // record the longest match
+                auto rule = table.GetToken(state);
+                if (rule >= 0) {
+                    last_rule_ = rule;
+                    last_end_ = pos_;
+                }
+                continue;
+            }
+        }
+        // current token can not be longer, emit it
+        if (last_rule_ >= 0) {
+            tokens.push_back({lexer_->tokens()[last_rule_], base_,
+                    last_end_ - base_});
+        }
+        else {
+            tokens.push_back({Lexer::kErrorToken, base_, 1});
+            last_end_ = base_ + 1;
+        }
+        // drop the bytes of emitted token & restart from the end of it
+        if (last_end_ < chunk_base) {
+            pending_.erase(0, last_end_ - base_);
+        }
+        else {
+            pending_.clear();
+        }
+        base_ = pos_ = last_end_;
+        last_rule_ = -1;
+        state = table.initial();
+    }
+    state_ = state;
+    // buffer the bytes of unfinished token in current chunk
+    if (base_ < chunk_end && len) {
+        auto begin = base_ > chunk_base ? base_ - chunk_base : 0;
+        pending_.append(data + begin, len - begin);
+    }
+}
+
+} // namespace rex::re
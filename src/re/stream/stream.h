@@ -0,0 +1,100 @@
+#ifndef REX_RE_STREAM_STREAM_H_
+#define REX_RE_STREAM_STREAM_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+#include <re/util/table.h>
+#include <re/lexer/lexer.h>
+
+namespace rex::re {
+
+// resumable matching context of a chunked input stream
+// NOTE:  answers if the whole stream matches, chunks are not copied
+class MatchStream {
+public:
+    MatchStream(const StateTablePtr &table) : table_(table) { Reset(); }
+    ~MatchStream() {}
+
+    // restart matching from the beginning of a new stream
+    void Reset() {
+        state_ = table_->initial();
+        size_ = 0;
+    }
+
+    // feed next chunk, returns false if the stream can no longer match
+    bool Feed(const char *data, std::size_t len) {
+        auto state = state_;
+        for (std::size_t i = 0; i < len && !table_->IsDead(state); ++i) {
+            state = table_->Next(state, data[i]);
+        }
+        state_ = state;
+        size_ += len;
+        return !table_->IsDead(state);
+    }
+
+    bool Feed(std::string_view chunk) {
+        return Feed(chunk.data(), chunk.size());
+    }
+
+    // end of stream, returns true if the whole stream matches
+    bool Finish() const { return table_->IsAccept(state_); }
+
+    // count of bytes that have been fed
+    std::size_t size() const { return size_; }
+    StateTable::StateId state() const { return state_; }
+
+private:
+    StateTablePtr table_;
+    StateTable::StateId state_;
+    std::size_t size_;
+};
+
+// resumable lexer of a chunked input stream
+// NOTE:  produces the same tokens as tokenizing the concatenation of
+//        all chunks, positions of tokens are offsets in the stream,
+//        only the bytes of the unfinished token will be buffered
+class TokenStream {
+public:
+    TokenStream(const LexerPtr &lexer) : lexer_(lexer) { Reset(); }
+    ~TokenStream() {}
+
+    // restart tokenizing from the beginning of a new stream
+    void Reset();
+
+    // feed next chunk, append all completed tokens to 'tokens'
+    void Feed(const char *data, std::size_t len,
+            std::vector<Token> &tokens);
+    void Feed(std::string_view chunk, std::vector<Token> &tokens) {
+        Feed(chunk.data(), chunk.size(), tokens);
+    }
+
+    // end of stream, append all remaining tokens to 'tokens'
+    void Finish(std::vector<Token> &tokens) {
+        Scan(nullptr, 0, true, tokens);
+    }
+
+    // count of bytes that have been fed
+    std::size_t size() const { return size_; }
+
+private:
+    void Scan(const char *data, std::size_t len, bool eof,
+            std::vector<Token> &tokens);
+
+    LexerPtr lexer_;
+    // bytes of unfinished token that come from previous chunks
+    std::string pending_;
+    // offset of the beginning of unfinished token & next byte in stream
+    std::size_t base_, pos_, size_;
+    // the longest match of unfinished token
+    int last_rule_;
+    std::size_t last_end_;
+    StateTable::StateId state_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_STREAM_STREAM_H_
@@ -0,0 +1,96 @@
+#ifndef REX_RE_UTIL_CHARCLASS_H_
+#define REX_RE_UTIL_CHARCLASS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+#include <re/util/charset.h>
+
+namespace rex::re {
+
+// partition of all byte values into disjoint equivalence classes
+// NOTE:  bytes in the same class can not be distinguished by any symbol
+//        that has been used to split the partition
+class CharClassMap {
+public:
+    CharClassMap() : class_count_(1) {
+        for (auto &&i : class_map_) i = 0;
+    }
+    ~CharClassMap() {}
+
+    // refine current partition so that 'char_set' is a union of classes
+    void Split(const CharSet &char_set) {
+        if (!char_set) return;
+        // count the bytes of each class that are included in char set
+        int size[256] = {0}, count[256] = {0};
+        for (int c = 0; c < 256; ++c) {
+            auto cls = class_map_[c];
+            ++size[cls];
+            if (char_set.Include(c)) ++count[cls];
+        }
+        // move the included part of a partially covered class to new class
+        int new_class[256];
+        auto old_count = class_count_;
+        for (std::size_t i = 0; i < old_count; ++i) {
+            new_class[i] = -1;
+            if (count[i] && count[i] != size[i]) {
+                new_class[i] = static_cast<int>(class_count_++);
+            }
+        }
+        for (int c = 0; c < 256; ++c) {
+            auto cls = class_map_[c];
+            if (new_class[cls] >= 0 && char_set.Include(c)) {
+                class_map_[c] = new_class[cls];
+            }
+        }
+    }
+
+    void Split(const SymbolPtr &symbol) {
+        CharSet char_set;
+        char_set.InsertSymbol(symbol);
+        Split(char_set);
+    }
+
+    // renumber classes by the order of their smallest byte
+    void Normalize() {
+        int new_class[256];
+        for (auto &&i : new_class) i = -1;
+        int cur_class = 0;
+        for (auto &&i : class_map_) {
+            if (new_class[i] < 0) new_class[i] = cur_class++;
+            i = new_class[i];
+        }
+    }
+
+    std::size_t GetClass(char c) const {
+        return class_map_[static_cast<std::uint8_t>(c)];
+    }
+
+    // get the smallest byte of specific class
+    char GetRepresentative(std::size_t cls) const {
+        assert(cls < class_count_);
+        for (int c = 0; c < 256; ++c) {
+            if (class_map_[c] == cls) return static_cast<char>(c);
+        }
+        return 0;
+    }
+
+    CharSet GetCharSet(std::size_t cls) const {
+        CharSet char_set;
+        for (int c = 0; c < 256; ++c) {
+            if (class_map_[c] == cls) char_set.Insert(static_cast<char>(c));
+        }
+        return char_set;
+    }
+
+    std::size_t class_count() const { return class_count_; }
+
+private:
+    std::size_t class_count_;
+    std::uint8_t class_map_[256];
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_UTIL_CHARCLASS_H_
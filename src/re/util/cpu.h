@@ -0,0 +1,29 @@
+#ifndef REX_RE_UTIL_CPU_H_
+#define REX_RE_UTIL_CPU_H_
+
+// runtime dispatch of SIMD code paths
+// NOTE:  functions marked with 'REX_RE_TARGET_SSSE3' can use SSSE3
+//        intrinsics even if the program is not compiled with '-mssse3',
+//        they must only be called if 'HasSSSE3()' returns true,
+//        dispatch is only available on x86 with GCC or Clang
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define REX_RE_SSSE3
+#define REX_RE_TARGET_SSSE3 __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#endif
+
+namespace rex::re {
+
+// check if SSSE3 is supported by current CPU
+inline bool HasSSSE3() {
+#ifdef REX_RE_SSSE3
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+    return has_ssse3;
+#else
+    return false;
+#endif
+}
+
+} // namespace rex::re
+
+#endif // REX_RE_UTIL_CPU_H_
@@ -0,0 +1,106 @@
+#ifndef REX_RE_UTIL_LITERAL_H_
+#define REX_RE_UTIL_LITERAL_H_
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rex::re {
+
+// find occurrences of a literal string in text
+// NOTE:  the first & last byte of literal are compared in a vector
+//        of positions at once if SSE2/AVX2 is available, and only
+//        the candidates that both bytes matched will be verified
+class LiteralFinder {
+public:
+    static constexpr auto npos = std::string_view::npos;
+
+    LiteralFinder() {}
+    LiteralFinder(const std::string &literal) : literal_(literal) {}
+    ~LiteralFinder() {}
+
+    // get the position of the first occurrence at or after 'pos'
+    std::size_t Find(std::string_view text, std::size_t pos = 0) const {
+        auto len = literal_.size();
+        if (pos > text.size() || text.size() - pos < len) return npos;
+        if (!len) return pos;
+        auto str = text.data() + pos, lit = literal_.data();
+        auto size = text.size() - pos;
+        if (len == 1) {
+            auto ptr = std::memchr(str, lit[0], size);
+            if (!ptr) return npos;
+            return static_cast<const char *>(ptr) - text.data();
+        }
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        const auto first = _mm256_set1_epi8(lit[0]);
+        const auto last = _mm256_set1_epi8(lit[len - 1]);
+        for (; i + len - 1 + 32 <= size; i += 32) {
+            auto block_first = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(str + i));
+            auto block_last = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(str + i + len - 1));
+            auto eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                                       _mm256_cmpeq_epi8(last, block_last));
+            auto mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+            for (; mask; mask &= mask - 1) {
+                auto offset = i + __builtin_ctz(mask);
+                if (Verify(str + offset)) return pos + offset;
+            }
+        }
+#elif defined(__SSE2__)
+        const auto first = _mm_set1_epi8(lit[0]);
+        const auto last = _mm_set1_epi8(lit[len - 1]);
+        for (; i + len - 1 + 16 <= size; i += 16) {
+            auto block_first = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(str + i));
+            auto block_last = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(str + i + len - 1));
+            auto eq = _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                    _mm_cmpeq_epi8(last, block_last));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+            for (; mask; mask &= mask - 1) {
+                auto offset = i + __builtin_ctz(mask);
+                if (Verify(str + offset)) return pos + offset;
+            }
+        }
+#endif
+        // scalar path, also handles the rest of text
+        while (i + len <= size) {
+            auto ptr = std::memchr(str + i, lit[0], size - len + 1 - i);
+            if (!ptr) return npos;
+            i = static_cast<const char *>(ptr) - str;
+            if (str[i + len - 1] == lit[len - 1] && Verify(str + i)) {
+                return pos + i;
+            }
+            ++i;
+        }
+        return npos;
+    }
+
+    // check if text contains the literal
+    bool Test(std::string_view text) const { return Find(text) != npos; }
+
+    bool empty() const { return literal_.empty(); }
+    const std::string &literal() const { return literal_; }
+
+private:
+    // check the middle part of literal, first & last byte are matched
+    bool Verify(const char *str) const {
+        auto len = literal_.size();
+        return !std::memcmp(str + 1, literal_.data() + 1, len - 2);
+    }
+
+    std::string literal_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_UTIL_LITERAL_H_
@@ -0,0 +1,127 @@
+#ifndef REX_RE_UTIL_POOL_H_
+#define REX_RE_UTIL_POOL_H_
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+namespace rex::re {
+
+class ThreadPool;
+
+using ThreadPoolPtr = std::shared_ptr<ThreadPool>;
+
+// pool of worker threads for data parallel jobs
+// NOTE:  the thread that calls 'ParallelFor' also works as worker 0,
+//        indices are handed out dynamically, so idle threads always
+//        take the next index, concurrent calls are serialized, and
+//        'ParallelFor' must not be called inside a job
+// NOTE:  if a call throws, the remaining indices are skipped, and the
+//        first exception is rethrown after all workers have stopped
+class ThreadPool {
+public:
+    ThreadPool(std::size_t thread_count = std::thread::hardware_concurrency())
+            : stop_(false), generation_(0), count_(0), active_(0) {
+        for (std::size_t i = 1; i < thread_count; ++i) {
+            workers_.emplace_back([this, i] { Work(i); });
+        }
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto &&i : workers_) i.join();
+    }
+
+    // call 'func(index, worker)' for all 'index' in '[0, count)',
+    // returns after all calls are finished, 'worker' is the index
+    // of the thread that runs the call (less than 'thread_count()')
+    template <typename Func>
+    void ParallelFor(std::size_t count, Func func) {
+        if (workers_.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) func(i, 0);
+            return;
+        }
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = [&func](std::size_t i, std::size_t worker) {
+                func(i, worker);
+            };
+            count_ = count;
+            next_ = 0;
+            active_ = workers_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        start_cv_.notify_all();
+        RunJob(0);
+        // wait for all workers, so that the job can be released
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return !active_; });
+        job_ = nullptr;
+        if (error_) std::rethrow_exception(std::move(error_));
+    }
+
+    std::size_t thread_count() const { return workers_.size() + 1; }
+
+private:
+    void RunJob(std::size_t worker) {
+        for (;;) {
+            auto i = next_.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count_) break;
+            try {
+                job_(i, worker);
+            }
+            catch (...) {
+                // keep the first exception, and skip the rest indices
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+                next_ = count_;
+            }
+        }
+    }
+
+    void Work(std::size_t worker) {
+        std::size_t generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [this, generation] {
+                    return stop_ || generation_ != generation;
+                });
+                if (stop_) return;
+                generation = generation_;
+            }
+            RunJob(worker);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!--active_) done_cv_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_, run_mutex_;
+    std::condition_variable start_cv_, done_cv_;
+    bool stop_;
+    // current job, identified by generation
+    std::size_t generation_;
+    std::function<void(std::size_t, std::size_t)> job_;
+    std::size_t count_;
+    std::atomic<std::size_t> next_;
+    // count of workers that have not finished current job
+    std::size_t active_;
+    // the first exception thrown by current job
+    std::exception_ptr error_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_UTIL_POOL_H_
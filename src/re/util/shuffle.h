@@ -0,0 +1,155 @@
+#ifndef REX_RE_UTIL_SHUFFLE_H_
+#define REX_RE_UTIL_SHUFFLE_H_
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+#include <re/util/table.h>
+#include <re/util/cpu.h>
+
+namespace rex::re {
+
+class ShuffleTable;
+
+using ShuffleTablePtr = std::shared_ptr<ShuffleTable>;
+
+// transition table of small DFA, the transitions of each char class
+// are stored in a 16-byte vector (state index -> next state index)
+// NOTE:  if SSSE3 is supported, the current state is kept in vector
+//        register, and each step is a single 'pshufb' on the vector
+//        of current chars, which does not depend on the current state,
+//        so the dependency chain is much shorter than table lookups
+// NOTE:  if there are not too many char classes, vectors of all pairs
+//        of classes are also precomputed, two pairs are composed by
+//        another 'pshufb' that is off the dependency chain, so there
+//        is only one dependent 'pshufb' every 4 chars
+class ShuffleTable {
+public:
+    // tables with more states can not be converted
+    static constexpr std::size_t kMaxStates = 16;
+    // pairs of classes are only precomputed if there are at most
+    // this many classes, so that they fit in L1 cache (16KB)
+    static constexpr std::size_t kMaxPairClasses = 32;
+
+    // convert from state table, which has at most 'kMaxStates' states
+    ShuffleTable(const StateTable &table)
+            : class_count_(table.class_count()), trans_(class_count_),
+              accept_(0) {
+        assert(table.state_count() <= kMaxStates);
+        for (int c = 0; c < 256; ++c) {
+            char_class_[c] = table.char_class_data()[c];
+        }
+        // unused states are dead
+        for (auto &&row : trans_) {
+            for (auto &&next : row.next) next = 0;
+        }
+        for (std::size_t i = 0; i < table.state_count(); ++i) {
+            auto state = table.GetState(i);
+            for (int c = 0; c < 256; ++c) {
+                auto next = table.Next(state, static_cast<char>(c));
+                trans_[char_class_[c]].next[i] = table.GetStateIndex(next);
+            }
+            if (table.IsAccept(state)) accept_ |= 1U << i;
+        }
+        initial_ = table.GetStateIndex(table.initial());
+        // pair (a, b) runs class 'a' first, then class 'b'
+        if (class_count_ > kMaxPairClasses) return;
+        pairs_.resize(class_count_ * class_count_);
+        for (std::size_t a = 0; a < class_count_; ++a) {
+            for (std::size_t b = 0; b < class_count_; ++b) {
+                auto &row = pairs_[a * class_count_ + b];
+                for (std::size_t i = 0; i < kMaxStates; ++i) {
+                    row.next[i] = trans_[b].next[trans_[a].next[i]];
+                }
+            }
+        }
+    }
+    ~ShuffleTable() {}
+
+    // run string from the state with specific index,
+    // returns index of the last state
+    std::uint8_t Run(std::uint8_t state, const char *str,
+            std::size_t len) const {
+#ifdef REX_RE_SSSE3
+        if (HasSSSE3()) return RunSSSE3(state, str, len);
+#endif
+        return RunScalar(state, str, len);
+    }
+
+    bool IsAccept(std::uint8_t state) const {
+        return accept_ & (1U << state);
+    }
+
+    bool TestString(const char *str, std::size_t len) const {
+        return IsAccept(Run(initial_, str, len));
+    }
+
+private:
+    // next states of all states, aligned for vector loads
+    struct alignas(16) Row {
+        std::uint8_t next[kMaxStates];
+    };
+
+#ifdef REX_RE_SSSE3
+    // run by shuffling the state vector, requires SSSE3
+    REX_RE_TARGET_SSSE3 std::uint8_t RunSSSE3(std::uint8_t state,
+            const char *str, std::size_t len) const {
+        // state is broadcast to all lanes, check the dead state
+        // once a block, so that the loop body stays short
+        constexpr std::size_t kBlockSize = 64;
+        auto s = reinterpret_cast<const std::uint8_t *>(str);
+        const auto *cls = char_class_;
+        std::size_t i = 0;
+        auto cur = _mm_set1_epi8(static_cast<char>(state));
+        for (; i + kBlockSize <= len && state; i += kBlockSize) {
+            if (pairs_.empty()) {
+                for (auto j = i; j < i + kBlockSize; ++j) {
+                    cur = _mm_shuffle_epi8(Load(trans_[cls[s[j]]]), cur);
+                }
+            }
+            else {
+                auto n = class_count_;
+                for (auto j = i; j < i + kBlockSize; j += 4) {
+                    auto p0 = Load(pairs_[cls[s[j]] * n + cls[s[j + 1]]]);
+                    auto p1 = Load(pairs_[cls[s[j + 2]] * n +
+                                          cls[s[j + 3]]]);
+                    // 'p0' is applied first
+                    cur = _mm_shuffle_epi8(_mm_shuffle_epi8(p1, p0), cur);
+                }
+            }
+            state = _mm_cvtsi128_si32(cur) & 0xff;
+        }
+        // handle the rest of string
+        return RunScalar(state, str + i, len - i);
+    }
+
+    static __m128i Load(const Row &row) {
+        return _mm_load_si128(reinterpret_cast<const __m128i *>(row.next));
+    }
+#endif
+
+    // run by looking up the table
+    std::uint8_t RunScalar(std::uint8_t state, const char *str,
+            std::size_t len) const {
+        for (std::size_t i = 0; i < len && state; ++i) {
+            auto c = static_cast<std::uint8_t>(str[i]);
+            state = trans_[char_class_[c]].next[state];
+        }
+        return state;
+    }
+
+    std::uint8_t char_class_[256];
+    std::size_t class_count_;
+    // rows of char classes & pairs of char classes
+    std::vector<Row> trans_, pairs_;
+    // bit mask of final states
+    std::uint32_t accept_;
+    std::uint8_t initial_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_UTIL_SHUFFLE_H_
@@ -1,11 +1,311 @@
 #ifndef REX_RE_UTIL_TABLE_H_
 #define REX_RE_UTIL_TABLE_H_
 
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
 #include <re/util/charset.h>
 
+namespace rex::re {
+
+class StateTable;
+
+using StateTablePtr = std::shared_ptr<StateTable>;
+
+// dense transition table of DFA (state x char class -> next state)
+// NOTE:  state 0 is always the dead state, and all of the state
+//        values stored in table are pre-multiplied row offsets,
+//        so that each step of matching only costs one load,
+//        the width of row is rounded up to a power of 2, so that
+//        row offsets can be converted to state indices by shifting
+// NOTE:  data of table can also be stored in external storage
+//        (e.g. memory mapped file), builder interfaces are not
+//        available in this case
 class StateTable {
 public:
-    //
+    using StateId = std::uint32_t;
+
+    StateTable(std::size_t state_count, std::size_t class_count)
+            : state_count_(state_count), class_count_(class_count),
+              shift_(0), initial_(0),
+              char_class_data_(256, 0),
+              accept_data_((state_count + 63) / 64, 0),
+              token_data_(state_count, -1) {
+        assert(state_count && class_count && class_count <= 256);
+        while ((1U << shift_) < class_count) ++shift_;
+        table_data_.resize(state_count << shift_, 0);
+        char_class_ = char_class_data_.data();
+        table_ = table_data_.data();
+        accept_ = accept_data_.data();
+        tokens_ = token_data_.data();
+    }
+    // create a table that references data in external storage,
+    // 'storage' will be kept alive until the table is destructed
+    StateTable(std::size_t state_count, std::size_t class_count,
+            std::size_t shift, StateId initial,
+            const std::uint8_t *char_class, const StateId *table,
+            const std::uint64_t *accept, const std::int32_t *tokens,
+            std::shared_ptr<const void> storage)
+            : state_count_(state_count), class_count_(class_count),
+              shift_(shift), initial_(initial), char_class_(char_class),
+              table_(table), accept_(accept), tokens_(tokens),
+              storage_(std::move(storage)) {
+        assert(state_count && class_count && class_count <= 256);
+        assert((1U << shift) >= class_count);
+    }
+    // tables can not be copied, data pointers reference owned storage
+    StateTable(const StateTable &) = delete;
+    StateTable &operator=(const StateTable &) = delete;
+    ~StateTable() {}
+
+    // builder interfaces, all states are represented by index
+    void SetCharClass(char c, std::size_t char_class) {
+        assert(!storage_ && char_class < class_count_);
+        char_class_data_[static_cast<std::uint8_t>(c)] = char_class;
+    }
+
+    void SetTransition(std::size_t state, std::size_t char_class,
+            std::size_t next) {
+        assert(!storage_);
+        assert(state < state_count_ && next < state_count_);
+        assert(char_class < class_count_);
+        table_data_[(state << shift_) + char_class] = next << shift_;
+    }
+
+    // mark state as a final state, with specific token of lexer
+    void SetAccept(std::size_t state, int token = 0) {
+        assert(!storage_ && state < state_count_);
+        accept_data_[state / 64] |= 1ULL << (state % 64);
+        token_data_[state] = token;
+    }
+
+    void set_initial(std::size_t state) {
+        assert(state < state_count_);
+        initial_ = state << shift_;
+    }
+
+    // matcher interfaces, all states are represented by row offset
+    StateId Next(StateId state, char c) const {
+        return table_[state + char_class_[static_cast<std::uint8_t>(c)]];
+    }
+
+    bool IsAccept(StateId state) const {
+        auto index = GetStateIndex(state);
+        return accept_[index / 64] & (1ULL << (index % 64));
+    }
+
+    bool IsDead(StateId state) const { return !state; }
+
+    // get token of final state, or -1 if state is not final
+    int GetToken(StateId state) const {
+        return tokens_[GetStateIndex(state)];
+    }
+
+    // conversions between row offsets & state indices
+    std::size_t GetStateIndex(StateId state) const {
+        return state >> shift_;
+    }
+
+    StateId GetState(std::size_t index) const {
+        return index << shift_;
+    }
+
+    // run string from the specific state, returns the last state
+    StateId Run(StateId state, const char *str, std::size_t len) const {
+        for (std::size_t i = 0; i < len && state; ++i) {
+            state = Next(state, str[i]);
+        }
+        return state;
+    }
+
+    // run string from all states at once, 'map[i]' will be set to
+    // the last state that reached from the state with index 'i',
+    // returns false if stopped by 'stop' before the end of string
+    // NOTE:  states usually converge quickly, so only distinct live
+    //        states are stepped, and they are deduplicated periodically,
+    //        the dead state is always kept at index 0 and never stepped
+    bool RunAll(const char *str, std::size_t len, std::vector<StateId> &map,
+            const std::atomic<bool> *stop = nullptr) const {
+        constexpr std::size_t kDedupInterval = 64;
+        constexpr auto kNone = ~static_cast<StateId>(0);
+        // distinct states, 'map' stores indices of them until the end
+        std::vector<StateId> states(state_count_), next;
+        map.resize(state_count_);
+        for (std::size_t i = 0; i < state_count_; ++i) {
+            states[i] = GetState(i);
+            map[i] = i;
+        }
+        std::vector<StateId> remap, slots(state_count_, kNone);
+        slots[0] = 0;
+        std::size_t pos = 0;
+        while (pos < len && states.size() > 2) {
+            if (stop && stop->load(std::memory_order_relaxed)) return false;
+            auto end = std::min(len, pos + kDedupInterval);
+            for (; pos < end; ++pos) {
+                for (std::size_t i = 1; i < states.size(); ++i) {
+                    states[i] = Next(states[i], str[pos]);
+                }
+            }
+            // merge states that have converged or died
+            next.assign(1, 0);
+            remap.resize(states.size());
+            for (std::size_t i = 0; i < states.size(); ++i) {
+                auto &slot = slots[GetStateIndex(states[i])];
+                if (slot == kNone) {
+                    slot = next.size();
+                    next.push_back(states[i]);
+                }
+                remap[i] = slot;
+            }
+            for (std::size_t i = 1; i < next.size(); ++i) {
+                slots[GetStateIndex(next[i])] = kNone;
+            }
+            if (next.size() != states.size()) {
+                for (auto &&i : map) i = remap[i];
+                states.swap(next);
+            }
+        }
+        // only one live state is left, run it as usual
+        if (states.size() == 2 && pos < len) {
+            states[1] = Run(states[1], str + pos, len - pos);
+        }
+        for (auto &&i : map) i = states[i];
+        return true;
+    }
+
+    bool TestString(const char *str, std::size_t len) const {
+        auto state = Run(initial_, str, len);
+        return state && IsAccept(state);
+    }
+
+    bool TestString(const std::string &str) const {
+        return TestString(str.data(), str.size());
+    }
+
+    // test strings in batch, 'strs[i]' is accepted if bit 'i % 64'
+    // of 'results[i / 64]' is set, 'results' must have at least
+    // '(count + 63) / 64' words
+    void TestStrings(const std::string_view *strs, std::size_t count,
+            std::uint64_t *results) const {
+        TestBatch(count, results, [strs](std::size_t i) {
+            return strs[i];
+        });
+    }
+
+    // same as above, but string 'i' is stored in
+    // 'buffer[offsets[i]]' to 'buffer[offsets[i + 1]]'
+    void TestStrings(const char *buffer, const std::size_t *offsets,
+            std::size_t count, std::uint64_t *results) const {
+        TestBatch(count, results, [buffer, offsets](std::size_t i) {
+            return std::string_view(buffer + offsets[i],
+                                     offsets[i + 1] - offsets[i]);
+        });
+    }
+
+    StateId initial() const { return initial_; }
+    std::size_t state_count() const { return state_count_; }
+    std::size_t class_count() const { return class_count_; }
+    std::size_t shift() const { return shift_; }
+    // raw data of table: char classes of all 256 bytes
+    const std::uint8_t *char_class_data() const { return char_class_; }
+    // transitions, 'state_count << shift' entries
+    const StateId *table_data() const { return table_; }
+    // bitmap of final states, '(state_count + 63) / 64' words
+    const std::uint64_t *accept_data() const { return accept_; }
+    // tokens of states, 'state_count' entries
+    const std::int32_t *token_data() const { return tokens_; }
+
+private:
+    // strings are matched in several lanes, the transitions of all
+    // lanes are looked up in an interleaved way, so that latencies
+    // of loads can overlap
+    // NOTE:  once a string ends or reaches the dead state, its lane
+    //        takes the next string, so lanes are always busy until
+    //        all strings are taken, then the rest are run one by one
+    template <typename GetString>
+    void TestBatch(std::size_t count, std::uint64_t *results,
+            GetString get_str) const {
+        constexpr std::size_t kLaneCount = 4;
+        for (std::size_t i = 0; i < (count + 63) / 64; ++i) results[i] = 0;
+        auto finish = [this, results](std::size_t index, StateId state) {
+            if (state && IsAccept(state)) {
+                results[index / 64] |= 1ULL << (index % 64);
+            }
+        };
+        const char *cur[kLaneCount], *end[kLaneCount];
+        std::size_t indices[kLaneCount];
+        StateId states[kLaneCount];
+        // put the next non-empty string to lane, returns false if
+        // there are no more strings
+        std::size_t next = 0;
+        auto fill = [&](std::size_t lane) {
+            for (; next < count; ++next) {
+                auto str = get_str(next);
+                if (str.empty()) {
+                    finish(next, initial_);
+                    continue;
+                }
+                cur[lane] = str.data();
+                end[lane] = str.data() + str.size();
+                indices[lane] = next++;
+                states[lane] = initial_;
+                return true;
+            }
+            return false;
+        };
+        std::size_t lane_count = 0;
+        while (lane_count < kLaneCount && fill(lane_count)) ++lane_count;
+        if (lane_count == kLaneCount) {
+            for (;;) {
+                for (std::size_t i = 0; i < kLaneCount; ++i) {
+                    states[i] = Next(states[i], *cur[i]++);
+                }
+                auto filled = true;
+                for (std::size_t i = 0; i < kLaneCount && filled; ++i) {
+                    if (cur[i] != end[i] && states[i]) continue;
+                    finish(indices[i], states[i]);
+                    filled = fill(i);
+                    // lane is empty, move the last lane to it
+                    if (!filled) {
+                        cur[i] = cur[--lane_count];
+                        end[i] = end[lane_count];
+                        indices[i] = indices[lane_count];
+                        states[i] = states[lane_count];
+                    }
+                }
+                if (!filled) break;
+            }
+        }
+        // run the rest of strings in lanes
+        for (std::size_t i = 0; i < lane_count; ++i) {
+            auto state = Run(states[i], cur[i], end[i] - cur[i]);
+            finish(indices[i], state);
+        }
+    }
+
+    std::size_t state_count_, class_count_, shift_;
+    StateId initial_;
+    // owned storage
+    std::vector<std::uint8_t> char_class_data_;
+    std::vector<StateId> table_data_;
+    std::vector<std::uint64_t> accept_data_;
+    std::vector<std::int32_t> token_data_;
+    // data of table, points to owned storage or external storage
+    const std::uint8_t *char_class_;
+    const StateId *table_;
+    const std::uint64_t *accept_;
+    const std::int32_t *tokens_;
+    std::shared_ptr<const void> storage_;
 };
 
+} // namespace rex::re
+
 #endif // REX_RE_UTIL_TABLE_H_
@@ -0,0 +1,62 @@
+#include <re/vm/vm.h>
+
+#include <utility>
+
+namespace rex::re {
+
+PikeVM::PikeVM(const NFAModelPtr &nfa) : nfa_(nfa) {
+    nfa_->NormalizeNFA();
+    // get char sets of all symbols
+    symbol_sets_.resize(nfa_->symbol_count());
+    for (NFAIndex i = 0; i < nfa_->symbol_count(); ++i) {
+        symbol_sets_[i].InsertSymbol(nfa_->symbol(i));
+    }
+}
+
+void PikeVM::AddThread(SparseSet &list, NFAIndex node,
+        std::vector<NFAIndex> &stack) const {
+    if (!list.Insert(node)) return;
+    stack.push_back(node);
+    while (!stack.empty()) {
+        auto cur_node = stack.back();
+        stack.pop_back();
+        for (auto arc = nfa_->arc_begin(cur_node);
+                arc != nfa_->arc_end(cur_node); ++arc) {
+            if (arc->symbol == kNFANone && list.Insert(arc->tail)) {
+                stack.push_back(arc->tail);
+            }
+        }
+    }
+}
+
+bool PikeVM::TestString(const char *str, std::size_t len) const {
+    return TestString({nfa_->start()}, str, len);
+}
+
+bool PikeVM::TestString(const std::vector<NFAIndex> &nodes,
+        const char *str, std::size_t len) const {
+    auto node_count = nfa_->node_count();
+    SparseSet cur_list(node_count), next_list(node_count);
+    std::vector<NFAIndex> stack;
+    stack.reserve(node_count);
+    for (const auto &node : nodes) AddThread(cur_list, node, stack);
+    for (std::size_t i = 0; i < len && !cur_list.Empty(); ++i) {
+        next_list.Clear();
+        for (const auto &node : cur_list) {
+            for (auto arc = nfa_->arc_begin(node);
+                    arc != nfa_->arc_end(node); ++arc) {
+                if (arc->symbol != kNFANone &&
+                        symbol_sets_[arc->symbol].Include(str[i])) {
+                    AddThread(next_list, arc->tail, stack);
+                }
+            }
+        }
+        std::swap(cur_list, next_list);
+    }
+    for (const auto &node : cur_list) {
+        if (nfa_->token(node) >= 0) return true;
+    }
+    return false;
+}
+
+} // namespace rex::re
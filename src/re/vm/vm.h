@@ -0,0 +1,76 @@
+#ifndef REX_RE_VM_VM_H_
+#define REX_RE_VM_VM_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include <re/nfa/nfa.h>
+#include <re/util/charset.h>
+
+namespace rex::re {
+
+class PikeVM;
+
+using PikeVMPtr = std::shared_ptr<PikeVM>;
+
+// set of NFA nodes that can be cleared in constant time
+class SparseSet {
+public:
+    SparseSet(std::size_t capacity)
+            : dense_(capacity), sparse_(capacity), size_(0) {}
+
+    bool Insert(NFAIndex value) {
+        if (Contains(value)) return false;
+        dense_[size_] = value;
+        sparse_[value] = size_++;
+        return true;
+    }
+
+    bool Contains(NFAIndex value) const {
+        auto index = sparse_[value];
+        return index < size_ && dense_[index] == value;
+    }
+
+    void Clear() { size_ = 0; }
+    bool Empty() const { return !size_; }
+
+    const NFAIndex *begin() const { return dense_.data(); }
+    const NFAIndex *end() const { return dense_.data() + size_; }
+    std::size_t size() const { return size_; }
+
+private:
+    std::vector<NFAIndex> dense_, sparse_;
+    std::size_t size_;
+};
+
+// simulate NFA directly (Thompson's construction & Pike's VM)
+// NOTE:  runs in O(n * m) time, no allocation while stepping
+class PikeVM {
+public:
+    PikeVM(const NFAModelPtr &nfa);
+    ~PikeVM() {}
+
+    bool TestString(const char *str, std::size_t len) const;
+    bool TestString(const std::string &str) const {
+        return TestString(str.data(), str.size());
+    }
+    // test string from a set of nodes instead of the start node
+    bool TestString(const std::vector<NFAIndex> &nodes, const char *str,
+            std::size_t len) const;
+
+    const NFAModelPtr &nfa() const { return nfa_; }
+
+private:
+    // add node & all nodes reachable by epsilon edges to thread list
+    void AddThread(SparseSet &list, NFAIndex node,
+            std::vector<NFAIndex> &stack) const;
+
+    NFAModelPtr nfa_;
+    std::vector<CharSet> symbol_sets_;
+};
+
+} // namespace rex::re
+
+#endif // REX_RE_VM_VM_H_
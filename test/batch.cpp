@@ -0,0 +1,58 @@
+// batch matching vs matching strings one by one
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+void TestBatch(Generator &gen, ThreadPool &pool) {
+    auto pattern = gen.Pattern(3);
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    // large batches are split into jobs of thread pool
+    auto count = gen.Rand(10) ? gen.Rand(200) : gen.Rand(3 * 4096);
+    std::vector<std::string> strs;
+    std::string buffer;
+    std::vector<std::size_t> offsets = {0};
+    for (std::size_t i = 0; i < count; ++i) {
+        // mixed lengths, so that lanes end at different positions
+        strs.push_back(gen.String(0, gen.Rand(4) ? 8 : 40));
+        buffer += strs.back();
+        offsets.push_back(buffer.size());
+    }
+    std::vector<std::string_view> views(strs.begin(), strs.end());
+    for (auto engine : {Regex::Engine::DFA, Regex::Engine::NFA}) {
+        Regex regex(reo, engine);
+        for (auto use_pool : {false, true}) {
+            auto p = use_pool ? &pool : nullptr;
+            std::vector<std::uint64_t> results((count + 63) / 64, ~0ULL);
+            std::vector<std::uint64_t> other = results;
+            regex.TestStrings(views.data(), count, results.data(), p);
+            regex.TestStrings(buffer.data(), offsets.data(), count,
+                    other.data(), p);
+            auto name = std::string(engine == Regex::Engine::DFA ? "DFA" :
+                    "NFA") + (use_pool ? " with pool" : "");
+            Check(results == other, "buffer " + name, pattern, "");
+            for (std::size_t i = 0; i < count; ++i) {
+                auto bit = (results[i / 64] >> (i % 64)) & 1;
+                Check(bit == regex.TestString(strs[i]), name, pattern,
+                        strs[i]);
+            }
+            // bits after the last string are cleared
+            if (count % 64) {
+                Check(!(results.back() >> (count % 64)), "padding " + name,
+                        pattern, "");
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    ThreadPool pool(4);
+    return RunTests(argc, argv, 300, [&pool](Generator &gen) {
+        TestBatch(gen, pool);
+    });
+}
@@ -0,0 +1,117 @@
+// binary save/load round trips of state tables & lexers
+// NOTE:  files are written to the current directory
+
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+const std::string kPath = "rex-test-binary.bin";
+const std::string kOtherPath = "rex-test-binary-other.bin";
+
+std::string ReadFile(const std::string &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(ifs),
+            std::istreambuf_iterator<char>()};
+}
+
+void WriteFile(const std::string &path, const std::string &data) {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs << data;
+}
+
+void TestTable(Generator &gen) {
+    auto pattern = gen.Pattern(3);
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    Regex regex(reo, Regex::Engine::DFA);
+    auto metadata = gen.String(0, 100);
+    Check(SaveStateTable(kPath, *regex.table(), metadata), "save", pattern,
+            "");
+    std::string loaded_metadata;
+    auto table = LoadStateTable(kPath, &loaded_metadata);
+    Check(table && IsSame(*table, *regex.table()) &&
+            loaded_metadata == metadata, "load", pattern, "");
+    if (!table) return;
+    for (int i = 0; i < 20; ++i) {
+        auto str = gen.String(0, 20);
+        Check(table->TestString(str) == regex.TestString(str),
+                "loaded table", pattern, str);
+    }
+    // the same pattern is always saved to the same bytes
+    Regex other(Parse(pattern), Regex::Engine::DFA);
+    SaveStateTable(kOtherPath, *other.table(), metadata);
+    Check(ReadFile(kPath) == ReadFile(kOtherPath), "same file", pattern,
+            "");
+}
+
+void TestLexer(Generator &gen) {
+    Lexer lexer;
+    auto count = 1 + gen.Rand(6);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (auto reo = Parse(gen.Pattern(2))) lexer.AddRule(reo, i * 3);
+    }
+    lexer.Build();
+    Check(SaveLexer(kPath, lexer), "save lexer", "", "");
+    auto loaded = LoadLexer(kPath);
+    Check(loaded && loaded->tokens() == lexer.tokens(), "load lexer", "",
+            "");
+    if (!loaded) return;
+    for (int i = 0; i < 20; ++i) {
+        auto str = gen.String(0, 20);
+        auto expected = lexer.Tokenize(str), tokens = loaded->Tokenize(str);
+        auto same = tokens.size() == expected.size();
+        for (std::size_t j = 0; j < tokens.size() && same; ++j) {
+            same = tokens[j].id == expected[j].id &&
+                   tokens[j].len == expected[j].len;
+        }
+        Check(same, "loaded lexer", "", str);
+    }
+}
+
+// files with corrupted data must be rejected
+void TestCorruption(Generator &gen) {
+    auto reo = Parse(gen.Pattern(3));
+    if (!reo) return;
+    Regex regex(reo, Regex::Engine::DFA);
+    SaveStateTable(kPath, *regex.table());
+    auto data = ReadFile(kPath);
+    BinaryHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    auto corrupt = [&data](std::uint64_t offset, auto value) {
+        auto copy = data;
+        std::memcpy(&copy[offset], &value, sizeof(value));
+        WriteFile(kPath, copy);
+        return !LoadStateTable(kPath);
+    };
+    auto state = gen.Rand(header.state_count);
+    auto entry = gen.Rand(header.state_count << header.shift);
+    Check(corrupt(header.token_offset + state * 4, std::int32_t(-2)),
+            "negative token", "", "");
+    Check(corrupt(header.table_offset + entry * 4,
+            StateTable::StateId(header.state_count << header.shift)),
+            "transition out of table", "", "");
+    Check(corrupt(header.char_class_offset + gen.Rand(256),
+            std::uint8_t(header.class_count)), "invalid char class", "", "");
+    WriteFile(kPath, data.substr(0, gen.Rand(data.size())));
+    Check(!LoadStateTable(kPath), "truncated file", "", "");
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    auto ret = RunTests(argc, argv, 200, [](Generator &gen) {
+        TestTable(gen);
+        TestLexer(gen);
+        TestCorruption(gen);
+    });
+    std::remove(kPath.c_str());
+    std::remove(kOtherPath.c_str());
+    return ret;
+}
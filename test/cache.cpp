@@ -0,0 +1,88 @@
+// RegexCache vs a simple LRU model of normalized patterns
+
+#include <list>
+#include <map>
+#include <algorithm>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+std::string Normalize(const std::string &pattern) {
+    Parser parser(pattern);
+    return parser.Parse() ? parser.normalized() : "";
+}
+
+// patterns that are written differently, some of them are the same
+std::vector<std::string> GetPatterns(Generator &gen) {
+    std::vector<std::string> patterns;
+    auto count = 1 + gen.Rand(8);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto pattern = gen.Pattern(2);
+        patterns.push_back(pattern);
+        patterns.push_back("(?:" + pattern + ")");
+    }
+    return patterns;
+}
+
+void TestLRU(Generator &gen) {
+    auto patterns = GetPatterns(gen);
+    auto capacity = 1 + gen.Rand(6);
+    RegexCache cache(capacity);
+    // normalized patterns in the order of use
+    std::list<std::string> model;
+    std::map<std::string, RegexPtr> cached;
+    for (int i = 0; i < 50; ++i) {
+        const auto &pattern = patterns[gen.Rand(patterns.size())];
+        auto key = Normalize(pattern);
+        auto regex = cache.Get(pattern);
+        Check(!regex == key.empty(), "invalid pattern", pattern, "");
+        if (!regex) continue;
+        auto it = std::find(model.begin(), model.end(), key);
+        if (it != model.end()) {
+            Check(regex == cached[key], "hit", pattern, "");
+            model.erase(it);
+        }
+        else {
+            Check(regex != cached[key], "miss", pattern, "");
+            cached[key] = regex;
+        }
+        model.push_front(key);
+        if (model.size() > capacity) model.pop_back();
+        Check(cache.size() == model.size(), "size", pattern, "");
+        auto str = gen.String(0, 10);
+        Check(regex->TestString(str) == Regex(Parse(pattern)).TestString(str),
+                "cached regex", pattern, str);
+    }
+    cache.Clear();
+    Check(!cache.size(), "clear", "", "");
+}
+
+// all threads get the same regex of the same pattern
+void TestThreads(Generator &gen, ThreadPool &pool) {
+    auto patterns = GetPatterns(gen);
+    RegexCache cache(patterns.size());
+    std::vector<RegexPtr> regexes(patterns.size() * 8);
+    pool.ParallelFor(regexes.size(), [&](std::size_t i, std::size_t) {
+        regexes[i] = cache.Get(patterns[i % patterns.size()]);
+    });
+    std::map<std::string, RegexPtr> cached;
+    for (std::size_t i = 0; i < regexes.size(); ++i) {
+        const auto &pattern = patterns[i % patterns.size()];
+        auto &regex = cached[Normalize(pattern)];
+        if (!regex) regex = regexes[i];
+        Check(regexes[i] == regex, "threads", pattern, "");
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    ThreadPool pool(4);
+    return RunTests(argc, argv, 200, [&pool](Generator &gen) {
+        TestLRU(gen);
+        TestThreads(gen, pool);
+    });
+}
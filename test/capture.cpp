@@ -0,0 +1,73 @@
+// CaptureRegex vs std::regex, both prefer the left alternative and
+// greedy repetitions
+// NOTE:  bodies of repetitions are never nullable in generated patterns,
+//        since std::regex rejects empty iterations, and groups are not
+//        nested in repetitions, since std::regex resets them on each
+//        iteration
+
+#include <regex>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// generate a pattern with capture groups
+std::string GetPattern(Generator &gen, int depth, bool in_repeat = false) {
+    auto group = [&gen, in_repeat](const std::string &pattern) {
+        return (!in_repeat && gen.Rand(2) ? "(" : "(?:") + pattern + ")";
+    };
+    switch (depth <= 0 ? gen.Rand(2) : gen.Rand(8)) {
+        case 0: return std::string(1, gen.Char());
+        case 1: return group(gen.String(1, 3));
+        case 2: case 3: {
+            auto lhs = GetPattern(gen, depth - 1, in_repeat);
+            return group(lhs + GetPattern(gen, depth - 1, in_repeat));
+        }
+        case 4: case 5: {
+            auto lhs = GetPattern(gen, depth - 1, in_repeat);
+            return group(lhs + "|" + GetPattern(gen, depth - 1, in_repeat));
+        }
+        case 6: return group(GetPattern(gen, depth - 1, in_repeat)) + "?";
+        default: {
+            // body of repetition must not be nullable
+            auto body = "(?:" + std::string(1, gen.Char()) + "(?:" +
+                        GetPattern(gen, depth - 1, true) + ")?)";
+            auto rep = gen.Rand(2) ? "*" : "+";
+            return (in_repeat ? "(?:" : "(") + body + rep + ")";
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 1000, [](Generator &gen) {
+        auto pattern = GetPattern(gen, 3);
+        auto reo = Parse(pattern);
+        if (!reo) return;
+        CaptureRegex regex(reo);
+        std::regex expected_regex(pattern);
+        auto group_count = expected_regex.mark_count() + 1;
+        Check(regex.group_count() == group_count, "group count", pattern,
+                "");
+        std::vector<Match> groups;
+        for (int i = 0; i < 20; ++i) {
+            auto str = gen.String(0, 10);
+            std::smatch expected;
+            auto matched = std::regex_match(str, expected, expected_regex);
+            auto result = regex.Extract(str, groups);
+            auto same = result == matched;
+            for (std::size_t j = 0; same && matched && j < group_count; ++j) {
+                Match match = {std::string_view::npos, 0};
+                if (expected[j].matched) {
+                    match = {static_cast<std::size_t>(expected.position(j)),
+                             static_cast<std::size_t>(expected.length(j))};
+                }
+                same = IsSame(groups[j], match);
+            }
+            Check(same, regex.one_pass() ? "one-pass" : "NFA", pattern, str);
+        }
+    });
+}
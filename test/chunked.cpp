@@ -0,0 +1,65 @@
+// chunked matching of large strings vs sequential matching
+
+#include <atomic>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// 'RunAll' vs 'Run' from every state
+void TestRunAll(Generator &gen) {
+    auto pattern = gen.Pattern(3);
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    Regex regex(reo, Regex::Engine::DFA);
+    const auto &table = *regex.table();
+    std::vector<StateTable::StateId> map;
+    for (int i = 0; i < 10; ++i) {
+        auto str = gen.String(0, 200);
+        Check(table.RunAll(str.data(), str.size(), map), "RunAll", pattern,
+                str);
+        auto same = map.size() == table.state_count();
+        for (std::size_t j = 0; j < map.size() && same; ++j) {
+            same = map[j] == table.Run(table.GetState(j), str.data(),
+                                       str.size());
+        }
+        Check(same, "RunAll", pattern, str);
+    }
+    // stopped before running
+    std::atomic<bool> stop(true);
+    std::string str(1000, 'a');
+    Check(table.state_count() <= 2 ||
+            !table.RunAll(str.data(), str.size(), map, &stop), "stop",
+            pattern, "");
+}
+
+// matching of the whole string in chunks vs sequential matching
+void TestChunks(Generator &gen, ThreadPool &pool) {
+    // repeated pattern, and strings of the repeated literal, so that
+    // long strings may still match
+    auto literal = gen.String(1, 3);
+    auto pattern = "(?:" + gen.Pattern(2) + "|" + literal + ")*";
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    Regex regex(reo, Regex::Engine::DFA);
+    auto len = Regex::kMinChunkSize * (1 + gen.Rand(5)) + gen.Rand(100);
+    std::string str;
+    while (str.size() < len) str += literal;
+    // change a random char
+    if (gen.Rand(2)) str[gen.Rand(str.size())] = gen.Char();
+    auto expected = regex.TestString(str);
+    Check(regex.TestString(str, pool) == expected, "chunks", pattern,
+            str.substr(0, 20));
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    ThreadPool pool(4);
+    return RunTests(argc, argv, 100, [&pool](Generator &gen) {
+        TestRunAll(gen);
+        TestChunks(gen, pool);
+    });
+}
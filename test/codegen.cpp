@@ -0,0 +1,64 @@
+// generated matchers & lexers vs Regex & Lexer of the same patterns
+// NOTE:  code is generated by 'rex-codegen-gen' at build time
+
+#include "test.h"
+#include "codegen.h"
+
+using namespace rex::test;
+
+namespace {
+
+// random string, some chars are out of the alphabet of patterns
+std::string GetString(Generator &gen) {
+    static const char kWideChars[] = "z_09 \n\x80\xff";
+    auto str = gen.String(0, 12);
+    for (auto &&c : str) {
+        if (!gen.Rand(4)) c = kWideChars[gen.Rand(sizeof(kWideChars) - 1)];
+    }
+    return str;
+}
+
+void TestMatcher(Generator &gen, const MatcherCase &cur) {
+    auto reo = Parse(cur.pattern);
+    if (!reo) return;
+    Regex regex(reo);
+    for (int i = 0; i < 30; ++i) {
+        auto str = GetString(gen);
+        Check(cur.match(str.data(), str.size()) == regex.TestString(str),
+                "generated matcher", cur.pattern, str);
+    }
+}
+
+void TestLexer(Generator &gen, const LexerCase &cur) {
+    Lexer lexer;
+    std::string_view rules = cur.rules;
+    for (int id = 0; !rules.empty(); ++id) {
+        auto end = std::min(rules.find(' '), rules.size());
+        auto reo = Parse(std::string(rules.substr(0, end)));
+        if (!reo) return;
+        lexer.AddRule(reo, id);
+        rules.remove_prefix(std::min(end + 1, rules.size()));
+    }
+    lexer.Build();
+    for (int i = 0; i < 30; ++i) {
+        auto str = GetString(gen);
+        auto token = lexer.ReadToken(str.data(), str.size());
+        std::size_t len = 0;
+        auto id = cur.lex(str.data(), str.size(), len);
+        Check(id == token.id && len == token.len, "generated lexer",
+                cur.rules, str);
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 1, [](Generator &gen) {
+        for (std::size_t i = 0; i < kMatcherCaseCount; ++i) {
+            TestMatcher(gen, kMatcherCases[i]);
+        }
+        for (std::size_t i = 0; i < kLexerCaseCount; ++i) {
+            TestLexer(gen, kLexerCases[i]);
+        }
+    });
+}
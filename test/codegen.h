@@ -0,0 +1,31 @@
+#ifndef REX_TEST_CODEGEN_H_
+#define REX_TEST_CODEGEN_H_
+
+// cases of code generator test, defined in the code that generated
+// by 'rex-codegen-gen' at build time
+
+#include <cstddef>
+
+namespace rex::test {
+
+// generated matcher of a pattern
+struct MatcherCase {
+    const char *pattern;
+    bool (*match)(const char *str, std::size_t len);
+};
+
+// generated lexer of rules, rules are separated by spaces,
+// token id of each rule is its index
+struct LexerCase {
+    const char *rules;
+    int (*lex)(const char *str, std::size_t len, std::size_t &token_len);
+};
+
+extern const MatcherCase kMatcherCases[];
+extern const std::size_t kMatcherCaseCount;
+extern const LexerCase kLexerCases[];
+extern const std::size_t kLexerCaseCount;
+
+} // namespace rex::test
+
+#endif // REX_TEST_CODEGEN_H_
@@ -0,0 +1,86 @@
+// generator of code generator test, writes generated matchers & lexers
+// of random patterns to a source file, which is compiled into test
+//
+// usage: rex-codegen-gen <output file>
+
+#include <fstream>
+#include <sstream>
+#include <iterator>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+constexpr int kMatcherCount = 300;
+constexpr int kLexerCount = 200;
+
+// random pattern, some of them have wider char classes,
+// so that all kinds of dispatches are generated
+std::string GetPattern(Generator &gen) {
+    static const char *kWidePatterns[] = {
+        "[^a]", ".", "[b-y0-9_]*", "\\w+", "[^ab\\n]", "\\d",
+    };
+    auto pattern = gen.Pattern(3);
+    if (gen.Rand(3)) return pattern;
+    return pattern + kWidePatterns[gen.Rand(std::size(kWidePatterns))];
+}
+
+// get C++ string literal of 'str'
+std::string GetLiteral(const std::string &str) {
+    std::string lit = "\"";
+    for (const auto &c : str) {
+        if (c == '\\' || c == '"') lit += '\\';
+        lit += c;
+    }
+    return lit + '"';
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    if (argc < 2) return 1;
+    std::ostringstream code, matchers, lexers;
+    for (int i = 0; i < kMatcherCount; ++i) {
+        Generator gen(i);
+        auto pattern = GetPattern(gen);
+        auto reo = Parse(pattern);
+        if (!reo) return 1;
+        Regex regex(reo, Regex::Engine::DFA);
+        auto name = "match" + std::to_string(i);
+        CodeGen(regex.table()).GenerateMatcher(code, name);
+        matchers << "    {" << GetLiteral(pattern) << ", " << name << "},\n";
+    }
+    for (int i = 0; i < kLexerCount; ++i) {
+        Generator gen(kMatcherCount + i);
+        Lexer lexer;
+        std::string rules;
+        auto count = 1 + gen.Rand(5);
+        for (std::size_t j = 0; j < count; ++j) {
+            auto pattern = GetPattern(gen);
+            auto reo = Parse(pattern);
+            if (!reo) return 1;
+            lexer.AddRule(reo, j);
+            rules += (j ? " " : "") + pattern;
+        }
+        lexer.Build();
+        auto name = "lex" + std::to_string(i);
+        CodeGen codegen(lexer.table());
+        codegen.set_tokens(lexer.tokens());
+        codegen.GenerateLexer(code, name);
+        lexers << "    {" << GetLiteral(rules) << ", " << name << "},\n";
+    }
+    std::ofstream ofs(argv[1]);
+    ofs << code.str() << "\n";
+    ofs << "#include \"codegen.h\"\n\n";
+    ofs << "namespace rex::test {\n\n";
+    ofs << "const MatcherCase kMatcherCases[] = {\n" << matchers.str();
+    ofs << "};\n";
+    ofs << "const std::size_t kMatcherCaseCount = " << kMatcherCount;
+    ofs << ";\n\n";
+    ofs << "const LexerCase kLexerCases[] = {\n" << lexers.str() << "};\n";
+    ofs << "const std::size_t kLexerCaseCount = " << kLexerCount << ";\n\n";
+    ofs << "} // namespace rex::test\n";
+    return ofs ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+// compile-time patterns vs Regex of the same patterns in text form
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+namespace ct = rex::re::ct;
+
+constexpr auto kPat0 = ct::Word("abc");
+constexpr auto kPat1 = (ct::Word("ab") | ct::Range('b', 'c')).Many();
+constexpr auto kPat2 = ct::Range('a', 'b') & ct::Word("c").Many1() &
+                       ct::Word("d").Optional();
+constexpr auto kPat3 = ct::Lambda([](char c) { return c == 'a' || c == 'c'; })
+                       .Many() & ct::Word("b");
+constexpr auto kPat4 = (ct::Word("a") | ct::Nil()) & (ct::Word("b") |
+                       ct::Word("bd")).Many() & ct::Word("dd").Optional();
+constexpr auto kPat5 = (ct::Range('a', 'd') & ct::Range('a', 'd')).Many() &
+                       ct::Word("a").Many1();
+constexpr auto kPat6 = ((ct::Word("a") | ct::Word("ab")) &
+                       (ct::Word("c") | ct::Word("bcd"))).Many1();
+constexpr auto kPat7 = ct::Nil();
+
+// results are also available at compile time
+static_assert(ct::Match<kPat0>("abc") && !ct::Match<kPat0>("ab"));
+static_assert(ct::Match<kPat6>("abcdac") && !ct::Match<kPat6>("abd"));
+
+template <const auto &Pat>
+void TestPattern(Generator &gen, const std::string &pattern) {
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    Regex regex(reo);
+    auto table = ct::kTable<Pat>.GenerateStateTable();
+    for (int i = 0; i < 50; ++i) {
+        auto str = gen.String(0, 12);
+        auto result = regex.TestString(str);
+        Check(ct::Match<Pat>(str) == result, "ct::Match", pattern, str);
+        Check(table->TestString(str.data(), str.size()) == result,
+                "ct::Table::GenerateStateTable", pattern, str);
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 100, [](Generator &gen) {
+        TestPattern<kPat0>(gen, "abc");
+        TestPattern<kPat1>(gen, "(?:ab|[b-c])*");
+        TestPattern<kPat2>(gen, "[a-b]c+d?");
+        TestPattern<kPat3>(gen, "[ac]*b");
+        TestPattern<kPat4>(gen, "a?(?:b|bd)*(?:dd)?");
+        TestPattern<kPat5>(gen, "(?:[a-d][a-d])*a+");
+        TestPattern<kPat6>(gen, "(?:(?:a|ab)(?:c|bcd))+");
+        TestPattern<kPat7>(gen, "");
+    });
+}
@@ -0,0 +1,22 @@
+// DFA vs NFA vs lazy DFA, anchored matching
+
+#include "test.h"
+
+using namespace rex::test;
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 500, [](Generator &gen) {
+        auto pattern = gen.Pattern(3);
+        auto reo = Parse(pattern);
+        if (!reo) return;
+        Regex dfa(reo, Regex::Engine::DFA), nfa(reo, Regex::Engine::NFA);
+        // small budget, so that cache flushes & fallbacks are also tested
+        LazyDFA lazy(reo->GenerateNFA(), 2048);
+        for (int i = 0; i < 20; ++i) {
+            auto str = gen.String(0, 4 * i);
+            auto result = nfa.TestString(str);
+            Check(dfa.TestString(str) == result, "DFA", pattern, str);
+            Check(lazy.TestString(str) == result, "lazy DFA", pattern, str);
+        }
+    });
+}
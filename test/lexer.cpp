@@ -0,0 +1,56 @@
+// Lexer vs brute-force maximal munch over each rule
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// read the longest non-empty token at 'pos', the first rule wins ties
+Token ReadToken(const std::vector<Regex> &rules, const std::string &str,
+        std::size_t pos) {
+    for (auto len = str.size() - pos; len; --len) {
+        for (std::size_t i = 0; i < rules.size(); ++i) {
+            if (rules[i].TestString(str.data() + pos, len)) {
+                return {static_cast<int>(i) * 10, pos, len};
+            }
+        }
+    }
+    return {Lexer::kErrorToken, pos, 1};
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 300, [](Generator &gen) {
+        Lexer lexer;
+        std::vector<Regex> rules;
+        std::string patterns;
+        auto count = 1 + gen.Rand(8);
+        for (std::size_t i = 0; i < count; ++i) {
+            auto pattern = gen.Pattern(2);
+            auto reo = Parse(pattern);
+            if (!reo) return;
+            // token ids differ from rule indices
+            lexer.AddRule(reo, i * 10);
+            rules.emplace_back(reo);
+            patterns += (i ? " " : "") + pattern;
+        }
+        lexer.Build();
+        for (int i = 0; i < 20; ++i) {
+            auto str = gen.String(0, 20);
+            auto tokens = lexer.Tokenize(str);
+            std::size_t pos = 0, index = 0;
+            auto same = true;
+            for (; pos < str.size() && same; ++index) {
+                auto token = ReadToken(rules, str, pos);
+                same = index < tokens.size() &&
+                       tokens[index].id == token.id &&
+                       tokens[index].pos == pos &&
+                       tokens[index].len == token.len;
+                pos += token.len;
+            }
+            Check(same && index == tokens.size(), "Tokenize", patterns, str);
+        }
+    });
+}
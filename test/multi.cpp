@@ -0,0 +1,86 @@
+// AhoCorasick & Teddy vs brute-force search of literals
+// NOTE:  both engines are constructed directly, since 'MakeMultiLiteral'
+//        picks only one of them on each host
+
+#include <algorithm>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// leftmost-longest occurrence of literals at or after 'pos'
+bool FindLiteral(const std::vector<std::string> &literals,
+        std::string_view text, std::size_t pos, Match &match) {
+    for (auto i = pos; i < text.size(); ++i) {
+        std::size_t len = 0;
+        for (const auto &lit : literals) {
+            if (text.substr(i, lit.size()) == lit) {
+                len = std::max(len, lit.size());
+            }
+        }
+        if (len) {
+            match = {i, len};
+            return true;
+        }
+    }
+    return false;
+}
+
+void TestMatcher(const MultiLiteralInterface &matcher, std::string_view name,
+        const std::vector<std::string> &literals, const std::string &text,
+        std::size_t pos) {
+    Match expected, match;
+    auto found = FindLiteral(literals, text, pos, expected);
+    auto result = matcher.Find(text, pos, match.pos, match.len);
+    std::string lits;
+    for (const auto &lit : literals) lits += (lits.empty() ? "" : "|") + lit;
+    Check(result == found && (!found || IsSame(match, expected)), name,
+            lits, text);
+}
+
+// alternation of many literals, which is a deeply nested chain
+void TestLargeSet() {
+    std::string pattern, text;
+    for (int i = 0; i < 50000; ++i) {
+        if (i) pattern += '|';
+        pattern += "w" + std::to_string(i) + "x";
+        if (i % 1000 == 7) text += "-w" + std::to_string(i) + "x";
+    }
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    std::vector<std::string> literals;
+    Check(reo->GetLiteralSet(literals) && literals.size() == 50000,
+            "GetLiteralSet", "w0x|w1x|...", "");
+    Searcher searcher(reo);
+    Check(searcher.Count(text) == 50, "large set", "w0x|w1x|...", text);
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    TestLargeSet();
+    return RunTests(argc, argv, 500, [](Generator &gen) {
+        std::vector<std::string> literals;
+        auto count = 1 + gen.Rand(gen.Rand(2) ? 8 : 80);
+        for (std::size_t i = 0; i < count; ++i) {
+            literals.push_back(gen.String(1, 5));
+        }
+        std::sort(literals.begin(), literals.end());
+        literals.erase(std::unique(literals.begin(), literals.end()),
+                literals.end());
+        AhoCorasick ac(literals);
+        auto multi = MakeMultiLiteral(literals);
+        for (int i = 0; i < 20; ++i) {
+            auto text = gen.String(0, 40);
+            auto pos = gen.Rand(text.size() + 1);
+            TestMatcher(ac, "AhoCorasick", literals, text, pos);
+            TestMatcher(*multi, "MakeMultiLiteral", literals, text, pos);
+            if (literals.size() <= TeddyMatcher::kMaxLiterals) {
+                TestMatcher(TeddyMatcher(literals), "Teddy", literals, text,
+                        pos);
+            }
+        }
+    });
+}
@@ -0,0 +1,79 @@
+// parallel subset construction vs sequential construction
+// NOTE:  tables must be identical, not only equivalent, since states
+//        are numbered by the order they were added to DFA
+
+#include <stdexcept>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+void TestLexer(Generator &gen, const std::vector<ThreadPoolPtr> &pools) {
+    std::vector<std::string> patterns;
+    auto count = 1 + gen.Rand(10);
+    for (std::size_t i = 0; i < count; ++i) {
+        patterns.push_back(gen.Pattern(3));
+    }
+    auto build = [&patterns](const ThreadPoolPtr &pool) {
+        Lexer lexer;
+        for (std::size_t i = 0; i < patterns.size(); ++i) {
+            if (auto reo = Parse(patterns[i])) lexer.AddRule(reo, i);
+        }
+        lexer.set_pool(pool);
+        lexer.Build();
+        return lexer.table();
+    };
+    auto table = build(nullptr);
+    Check(IsSame(*table, *build(nullptr)), "sequential lexer",
+            patterns[0], "");
+    for (const auto &pool : pools) {
+        auto name = "lexer with " + std::to_string(pool->thread_count()) +
+                    " thread(s)";
+        Check(IsSame(*table, *build(pool)), name, patterns[0], "");
+    }
+}
+
+void TestNFA(Generator &gen, const std::vector<ThreadPoolPtr> &pools) {
+    auto pattern = gen.Pattern(4);
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    // tables are also compared before minimization
+    auto table = reo->GenerateNFA()->GenerateDFA()->GenerateStateTable();
+    for (const auto &pool : pools) {
+        auto dfa = reo->GenerateNFA()->GenerateDFA(0, *pool);
+        Check(IsSame(*table, *dfa->GenerateStateTable()), "GenerateDFA",
+                pattern, "");
+    }
+}
+
+// exceptions thrown by jobs are rethrown by 'ParallelFor'
+void TestException(const std::vector<ThreadPoolPtr> &pools) {
+    for (const auto &pool : pools) {
+        auto caught = false;
+        try {
+            pool->ParallelFor(100, [](std::size_t i, std::size_t) {
+                if (i == 42) throw std::runtime_error("job failed");
+            });
+        }
+        catch (const std::runtime_error &) {
+            caught = true;
+        }
+        Check(caught, "exception of ParallelFor", "", "");
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    std::vector<ThreadPoolPtr> pools;
+    for (auto count : {1, 2, 4}) {
+        pools.push_back(std::make_shared<ThreadPool>(count));
+    }
+    TestException(pools);
+    return RunTests(argc, argv, 200, [&pools](Generator &gen) {
+        TestLexer(gen, pools);
+        TestNFA(gen, pools);
+    });
+}
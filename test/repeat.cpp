@@ -0,0 +1,72 @@
+// bounded repetitions vs manually expanded patterns
+
+#include <chrono>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// expand 'x{min,max}' to 'xx...x(?:x(?:x)?)?'
+std::string Expand(const std::string &x, std::size_t min, std::size_t max,
+        bool unbounded) {
+    std::string pattern;
+    for (std::size_t i = 0; i < min; ++i) pattern += x;
+    if (unbounded) return pattern + x + "*";
+    for (auto i = min; i < max; ++i) pattern += "(?:" + x;
+    for (auto i = min; i < max; ++i) pattern += ")?";
+    return pattern;
+}
+
+void TestRepeat(Generator &gen) {
+    auto x = "(?:" + gen.Pattern(2) + ")";
+    auto min = gen.Rand(4), max = min + gen.Rand(4);
+    auto unbounded = !gen.Rand(4);
+    auto pattern = x + "{" + std::to_string(min) + "," +
+                   (unbounded ? "" : std::to_string(max)) + "}";
+    auto reo = Parse(pattern), expanded = Parse(Expand(x, min, max,
+            unbounded));
+    if (!reo || !expanded) return;
+    Regex expected(expanded);
+    Regex dfa(reo, Regex::Engine::DFA), nfa(reo, Regex::Engine::NFA);
+    for (int i = 0; i < 20; ++i) {
+        auto str = gen.String(0, 12);
+        auto result = expected.TestString(str);
+        Check(dfa.TestString(str) == result, "DFA", pattern, str);
+        Check(nfa.TestString(str) == result, "NFA", pattern, str);
+    }
+}
+
+// large bounds must not blow up the DFA of 'Auto' engine
+void TestLargeRepeat(Generator &gen) {
+    auto n = 1 + gen.Rand(Parser::kMaxRepeat);
+    auto pattern = "[ab]*a[ab]{1," + std::to_string(n) + "}";
+    auto begin = std::chrono::steady_clock::now();
+    Regex regex(Parse(pattern));
+    auto time = std::chrono::steady_clock::now() - begin;
+    Check(time < std::chrono::seconds(1), "compile time", pattern, "");
+    Check(n <= Regex::kMaxDFARepeat ||
+            regex.engine() == Regex::Engine::NFA, "engine", pattern, "");
+    for (int i = 0; i < 20; ++i) {
+        auto str = gen.String(0, 20);
+        // brute force, some 'a' is followed by 1 to 'n' chars
+        auto result = str.find_first_not_of("ab") == std::string::npos;
+        auto found = false;
+        for (std::size_t j = 0; j < str.size() && result; ++j) {
+            auto rest = str.size() - j - 1;
+            if (str[j] == 'a' && rest >= 1 && rest <= n) found = true;
+        }
+        result = result && found;
+        Check(regex.TestString(str) == result, "large bound", pattern, str);
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 300, [](Generator &gen) {
+        TestRepeat(gen);
+        if (!gen.Rand(10)) TestLargeRepeat(gen);
+    });
+}
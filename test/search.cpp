@@ -0,0 +1,31 @@
+// Searcher vs brute-force leftmost-longest search
+
+#include "test.h"
+
+using namespace rex::test;
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 500, [](Generator &gen) {
+        auto pattern = gen.Pattern(3);
+        auto reo = Parse(pattern);
+        if (!reo) return;
+        Searcher searcher(reo);
+        Regex regex(reo);
+        for (int i = 0; i < 10; ++i) {
+            auto str = gen.String(0, 24);
+            auto expected = FindAllMatches(regex, str);
+            Check(IsSame(searcher.FindAll(str), expected), "FindAll",
+                    pattern, str);
+            Check(searcher.Count(str) == expected.size(), "Count",
+                    pattern, str);
+            // find from the middle of string
+            auto pos = gen.Rand(str.size() + 1);
+            auto first = FindAllMatches(regex, str, pos);
+            Match match;
+            auto found = searcher.Find(str, match, pos);
+            Check(found == !first.empty() &&
+                    (!found || IsSame(match, first[0])), "Find", pattern,
+                    str);
+        }
+    });
+}
@@ -0,0 +1,47 @@
+// RegexSet vs each Regex, anchored & unanchored sets
+
+#include <algorithm>
+
+#include "test.h"
+
+using namespace rex::test;
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 300, [](Generator &gen) {
+        std::vector<std::string> patterns;
+        std::vector<REObject> reos;
+        std::vector<Regex> regexes;
+        auto count = 1 + gen.Rand(20);
+        for (std::size_t i = 0; i < count; ++i) {
+            patterns.push_back(gen.Pattern(2));
+            reos.push_back(Parse(patterns.back()));
+            if (!reos.back()) return;
+            regexes.emplace_back(reos.back());
+        }
+        for (auto anchored : {true, false}) {
+            // small limit, so that partitions & fallback engines
+            // are also tested
+            auto max_states = gen.Rand(2) ? 8 : RegexSet::kMaxStates;
+            RegexSet set(reos, anchored, max_states);
+            auto name = anchored ? "RegexSet" : "unanchored RegexSet";
+            Check(set.size() == count, name, "", "");
+            for (int i = 0; i < 20; ++i) {
+                auto str = gen.String(0, 12);
+                std::vector<std::size_t> ids;
+                auto result = set.Match(str, ids), any = false;
+                Check(std::is_sorted(ids.begin(), ids.end()), name, "", str);
+                for (std::size_t j = 0; j < count; ++j) {
+                    auto matched = anchored
+                            ? regexes[j].TestString(str)
+                            : !FindAllMatches(regexes[j], str).empty();
+                    auto reported =
+                            std::binary_search(ids.begin(), ids.end(), j);
+                    Check(reported == matched, name, patterns[j], str);
+                    any |= matched;
+                }
+                Check(result == any && set.IsMatch(str) == any, name, "",
+                        str);
+            }
+        }
+    });
+}
@@ -0,0 +1,68 @@
+// shuffle tables vs state tables of small DFAs
+
+#include <cctype>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// random string of chars in 'chars', some parts are repeated, so that
+// long strings may still be accepted
+std::string GetString(Generator &gen, const std::string &chars,
+        std::size_t max_len) {
+    std::string str, unit;
+    auto len = gen.Rand(max_len + 1);
+    for (auto i = 1 + gen.Rand(3); i; --i) {
+        unit += chars[gen.Rand(chars.size())];
+    }
+    while (str.size() < len) {
+        str += gen.Rand(8) ? unit : std::string(1, chars[gen.Rand(
+                chars.size())]);
+    }
+    str.resize(len);
+    return str;
+}
+
+void TestPattern(Generator &gen, const std::string &pattern,
+        const std::string &chars) {
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    Regex regex(reo, Regex::Engine::DFA);
+    const auto &table = *regex.table();
+    if (table.state_count() > ShuffleTable::kMaxStates) return;
+    ShuffleTable shuffle(table);
+    for (int i = 0; i < 20; ++i) {
+        // longer than blocks of vector path
+        auto str = GetString(gen, chars, 300);
+        Check(shuffle.TestString(str.data(), str.size()) ==
+                table.TestString(str), "ShuffleTable", pattern, str);
+        // run from all states
+        auto same = true;
+        for (std::size_t j = 0; j < table.state_count() && same; ++j) {
+            auto state = table.Run(table.GetState(j), str.data(),
+                                   str.size());
+            same = shuffle.Run(j, str.data(), str.size()) ==
+                   table.GetStateIndex(state);
+        }
+        Check(same, "Run", pattern, str);
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 500, [](Generator &gen) {
+        auto pattern = gen.Pattern(3);
+        TestPattern(gen, "(?:" + pattern + ")*", "abcd");
+        // too many char classes to precompute pairs
+        std::string wide = "(?:" + pattern, chars = "abcd";
+        for (char c = '0'; c <= 'z'; ++c) {
+            if (!std::isalnum(c) || (c >= 'a' && c <= 'd')) continue;
+            wide += std::string("|") + c;
+            chars += c;
+        }
+        TestPattern(gen, wide + ")*", chars);
+    });
+}
@@ -0,0 +1,72 @@
+// compilation with statistics vs compilation without statistics
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// fields must be consistent with each other and with the models
+void CheckStats(const CompileStats &stats, const StateTablePtr &table,
+        const std::string &pattern) {
+    Check(stats.total_time() == stats.nfa_time + stats.normalize_time +
+            stats.dfa_time + stats.simplify_time + stats.build_time,
+            "total time", pattern, "");
+    Check(stats.nfa_nodes && stats.nfa_edges && stats.nfa_bytes,
+            "NFA size", pattern, "");
+    auto peak = stats.structural_peak_bytes;
+    Check(peak >= stats.nfa_bytes && peak >= stats.dfa_bytes &&
+            peak >= stats.table_bytes, "peak bytes", pattern, "");
+    if (!table) return;
+    Check(stats.min_dfa_states && stats.min_dfa_states <= stats.dfa_states,
+            "DFA states", pattern, "");
+    Check(stats.class_count == table->class_count() && stats.table_bytes,
+            "state table", pattern, "");
+}
+
+void TestRegex(Generator &gen) {
+    auto pattern = gen.Pattern(3);
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    for (auto engine : {Regex::Engine::DFA, Regex::Engine::NFA}) {
+        CompileStats stats;
+        Regex regex(reo, engine, &stats), expected(reo, engine);
+        CheckStats(stats, regex.table(), pattern);
+        if (regex.table()) {
+            Check(IsSame(*regex.table(), *expected.table()), "table",
+                    pattern, "");
+        }
+        for (int i = 0; i < 20; ++i) {
+            auto str = gen.String(0, 12);
+            Check(regex.TestString(str) == expected.TestString(str),
+                    "regex", pattern, str);
+        }
+    }
+}
+
+void TestLexer(Generator &gen) {
+    Lexer lexer, expected;
+    auto count = 1 + gen.Rand(6);
+    std::string pattern;
+    for (std::size_t i = 0; i < count; ++i) {
+        pattern = gen.Pattern(2);
+        auto reo = Parse(pattern);
+        if (!reo) continue;
+        lexer.AddRule(reo, i);
+        expected.AddRule(reo, i);
+    }
+    CompileStats stats;
+    lexer.Build(&stats);
+    expected.Build();
+    CheckStats(stats, lexer.table(), pattern);
+    Check(IsSame(*lexer.table(), *expected.table()), "lexer", pattern, "");
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 300, [](Generator &gen) {
+        TestRegex(gen);
+        TestLexer(gen);
+    });
+}
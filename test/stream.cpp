@@ -0,0 +1,80 @@
+// MatchStream & TokenStream vs matching the whole input at once
+
+#include <algorithm>
+
+#include "test.h"
+
+using namespace rex::test;
+
+namespace {
+
+// split string into random chunks, including empty chunks
+std::vector<std::string_view> Split(Generator &gen, std::string_view str) {
+    std::vector<std::string_view> chunks;
+    std::size_t pos = 0;
+    while (pos < str.size()) {
+        auto len = std::min(gen.Rand(6), str.size() - pos);
+        chunks.push_back(str.substr(pos, len));
+        pos += len;
+    }
+    return chunks;
+}
+
+bool IsSame(const Token &lhs, const Token &rhs) {
+    return lhs.id == rhs.id && lhs.pos == rhs.pos && lhs.len == rhs.len;
+}
+
+void TestMatchStream(Generator &gen) {
+    auto pattern = gen.Pattern(3);
+    auto reo = Parse(pattern);
+    if (!reo) return;
+    Regex regex(reo, Regex::Engine::DFA);
+    MatchStream stream(regex.table());
+    for (int i = 0; i < 20; ++i) {
+        auto str = gen.String(0, 30);
+        stream.Reset();
+        auto alive = true;
+        for (const auto &chunk : Split(gen, str)) alive = stream.Feed(chunk);
+        auto result = regex.TestString(str);
+        Check(stream.Finish() == result && (alive || !result),
+                "MatchStream", pattern, str);
+        Check(stream.size() == str.size(), "MatchStream size", pattern, str);
+    }
+}
+
+void TestTokenStream(Generator &gen) {
+    auto lexer = std::make_shared<Lexer>();
+    std::string patterns;
+    auto count = 1 + gen.Rand(6);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto pattern = gen.Pattern(2);
+        auto reo = Parse(pattern);
+        if (!reo) return;
+        lexer->AddRule(reo, i);
+        patterns += (i ? " " : "") + pattern;
+    }
+    lexer->Build();
+    TokenStream stream(lexer);
+    for (int i = 0; i < 20; ++i) {
+        auto str = gen.String(0, 30);
+        auto expected = lexer->Tokenize(str);
+        std::vector<Token> tokens;
+        stream.Reset();
+        for (const auto &chunk : Split(gen, str)) stream.Feed(chunk, tokens);
+        stream.Finish(tokens);
+        auto same = tokens.size() == expected.size();
+        for (std::size_t j = 0; j < tokens.size() && same; ++j) {
+            same = IsSame(tokens[j], expected[j]);
+        }
+        Check(same, "TokenStream", patterns, str);
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    return RunTests(argc, argv, 300, [](Generator &gen) {
+        TestMatchStream(gen);
+        TestTokenStream(gen);
+    });
+}
@@ -0,0 +1,170 @@
+#ifndef REX_TEST_TEST_H_
+#define REX_TEST_TEST_H_
+
+// helpers of randomized equivalence tests
+// NOTE:  each test is a standalone program, which generates random
+//        patterns & strings over a small alphabet from a sequence of
+//        seeds, and compares the results of different engines,
+//        usage: 'rex-test-<name> [seed count]'
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <utility>
+#include <cstddef>
+#include <cstdlib>
+
+#include <re/re.h>
+
+namespace rex::test {
+
+using namespace rex::re;
+
+// generator of random patterns & strings
+class Generator {
+public:
+    Generator(unsigned seed) : rng_(seed) {}
+
+    // generate a pattern in text form
+    std::string Pattern(int depth) {
+        switch (depth <= 0 ? Rand(3) : Rand(9)) {
+            case 0: return std::string(1, Char());
+            case 1: {
+                auto a = Char(), b = Char();
+                if (a > b) std::swap(a, b);
+                return std::string("[") + a + '-' + b + ']';
+            }
+            case 2: return "(?:" + String(1, 3) + ")";
+            case 3: case 4: {
+                return "(?:" + Pattern(depth - 1) + Pattern(depth - 1) + ")";
+            }
+            case 5: case 6: {
+                auto lhs = Pattern(depth - 1), rhs = Pattern(depth - 1);
+                return "(?:" + lhs + "|" + rhs + ")";
+            }
+            case 7: return "(?:" + Pattern(depth - 1) + ")*";
+            default: {
+                auto rep = Rand(2) ? ")?" : ")+";
+                return "(?:" + Pattern(depth - 1) + rep;
+            }
+        }
+    }
+
+    // generate a string with length in [min_len, max_len]
+    std::string String(std::size_t min_len, std::size_t max_len) {
+        std::string str(min_len + Rand(max_len - min_len + 1), 0);
+        for (auto &&c : str) c = Char();
+        return str;
+    }
+
+    // random number in [0, n)
+    std::size_t Rand(std::size_t n) { return rng_() % n; }
+
+    // random char of the alphabet
+    char Char() { return 'a' + Rand(4); }
+
+private:
+    std::mt19937 rng_;
+};
+
+// count of failed cases
+inline int failed = 0;
+
+// report a failed case if 'cond' is false
+inline void Check(bool cond, std::string_view name,
+        std::string_view pattern, std::string_view str) {
+    if (cond) return;
+    if (failed++ < 10) {
+        std::cerr << "FAILED: " << name << ", pattern '" << pattern
+                  << "', string '" << str << "'" << std::endl;
+    }
+}
+
+// parse pattern, failures are reported
+inline REObject Parse(const std::string &pattern) {
+    auto reo = Parser(pattern).Parse();
+    Check(!!reo, "parser", pattern, "");
+    return reo;
+}
+
+// leftmost-longest non-overlapping matches from 'pos',
+// found by trying all substrings
+inline std::vector<Match> FindAllMatches(const Regex &regex,
+        std::string_view str, std::size_t pos = 0) {
+    std::vector<Match> matches;
+    while (pos <= str.size()) {
+        auto found = false;
+        for (auto begin = pos; begin <= str.size() && !found; ++begin) {
+            for (auto end = str.size() + 1; end-- > begin;) {
+                if (regex.TestString(str.data() + begin, end - begin)) {
+                    matches.push_back({begin, end - begin});
+                    pos = end > begin ? end : end + 1;
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found) break;
+    }
+    return matches;
+}
+
+inline bool IsSame(const Match &lhs, const Match &rhs) {
+    return lhs.pos == rhs.pos && lhs.len == rhs.len;
+}
+
+inline bool IsSame(const std::vector<Match> &lhs,
+        const std::vector<Match> &rhs) {
+    if (lhs.size() != rhs.size()) return false;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        if (!IsSame(lhs[i], rhs[i])) return false;
+    }
+    return true;
+}
+
+// check if two state tables have the same states, transitions & tokens
+inline bool IsSame(const StateTable &lhs, const StateTable &rhs) {
+    if (lhs.state_count() != rhs.state_count() ||
+            lhs.class_count() != rhs.class_count() ||
+            lhs.GetStateIndex(lhs.initial()) !=
+                    rhs.GetStateIndex(rhs.initial())) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.state_count(); ++i) {
+        auto l = lhs.GetState(i), r = rhs.GetState(i);
+        if (lhs.IsAccept(l) != rhs.IsAccept(r) ||
+                lhs.GetToken(l) != rhs.GetToken(r)) {
+            return false;
+        }
+        for (int c = 0; c < 256; ++c) {
+            auto ch = static_cast<char>(c);
+            if (lhs.GetStateIndex(lhs.Next(l, ch)) !=
+                    rhs.GetStateIndex(rhs.Next(r, ch))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// run 'test' with seeds in [0, seed count), returns exit code
+template <typename Test>
+int RunTests(int argc, const char *argv[], int default_count, Test test) {
+    auto seed_count = argc > 1 ? std::atoi(argv[1]) : default_count;
+    for (int seed = 0; seed < seed_count; ++seed) {
+        Generator gen(seed);
+        test(gen);
+    }
+    if (failed) {
+        std::cerr << failed << " case(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
+
+} // namespace rex::test
+
+#endif // REX_TEST_TEST_H_